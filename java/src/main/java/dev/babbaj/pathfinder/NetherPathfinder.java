@@ -26,7 +26,24 @@ public class NetherPathfinder {
 
     // pass true to use the custom chunk allocator that will reduce memory usage and maybe be faster. false to just use new/delete
     // this is only supported on systems with 4k pages
-    public static native long newContext(long seed, String baritoneCacheDirCanBeNull, int dimension, int maxHeight, boolean allocator);
+    public static long newContext(long seed, String baritoneCacheDirCanBeNull, int dimension, int maxHeight, boolean allocator) {
+        return newContext(seed, baritoneCacheDirCanBeNull, dimension, maxHeight, allocator, -1);
+    }
+
+    // threads >= 0 gives the context its own thread pool with that many threads (0 runs everything on the calling thread),
+    // a negative number makes it use the pool shared by every context (see setThreadPoolSize)
+    public static native long newContext(long seed, String baritoneCacheDirCanBeNull, int dimension, int maxHeight, boolean allocator, int threads);
+
+    // Replaces the thread pool shared by the contexts made after this call, negative for one thread less than the number of cores.
+    // All the parallel work of a context (chunk generation for the search, pregenerate) runs on one pool, the thread that
+    // calls in works on it too so it never uses more threads than that.
+    public static void setThreadPoolSize(int threads) {
+        setThreadPoolSize(threads, false);
+    }
+
+    // pinToCores puts every thread of the pool on its own physical core (not the first one) on linux and windows,
+    // which can help when the rest of the machine is idle and hurts when it isn't
+    public static native void setThreadPoolSize(int threads, boolean pinToCores);
     public static native void freeContext(long pointer);
 
     /*
@@ -42,9 +59,11 @@ public class NetherPathfinder {
 
     public static native long allocateAndInsertChunk(long context, int x, int z);
 
-    // do not write to the chunk this returns
+    // Do not write to the chunk this returns. The pointer stays valid until the chunk is replaced or culled, generated
+    // chunks that have been returned here are never compressed.
     public static native long getChunkOrDefault(long context, int x, int z, boolean solid);
 
+    // the pointer stays valid like the one of getChunkOrDefault
     public static native long getChunk(long context, int x, int z);
 
     // returns true if the chunk existed and the change was made
@@ -54,6 +73,64 @@ public class NetherPathfinder {
 
     public static native void cullFarChunks(long context, int chunkX, int chunkZ, int maxDistanceBlocks);
 
+    // Generated chunks that haven't been accessed for coldAfterMillis are compressed on a background thread and
+    // transparently decompressed when they are accessed again. 0 (the default) disables compression.
+    public static native void setChunkCompression(long context, int coldAfterMillis);
+
+    // {hits, misses (decompressions), compressed chunks, compressed bytes}
+    public static native long[] getChunkCompressionStats(long context);
+
+    // Keeps up to maxColumns noise lattice columns (136 bytes each) so chunks generated next to already generated ones
+    // can reuse the columns on their shared edges. 0 (the default) disables it.
+    public static native void setNoiseColumnCache(long context, int maxColumns);
+
+    // {hits, misses (in lattice columns), cached columns, chunks generated with the cache enabled, nanoseconds spent generating them}
+    public static native long[] getNoiseColumnCacheStats(long context);
+
+    // Generates the chunks a search is expected to need (along the line to the goal and ahead of the best node) on a low
+    // priority background thread while it runs. Only used when fake chunks are generated. Disabled by default.
+    public static native void setSpeculativeGeneration(long context, boolean enabled);
+
+    // {chunks generated in the background, chunks that were used (the rest were generated by the search first)}
+    public static native long[] getSpeculativeGenerationStats(long context);
+
+    // Makes the search only generate the 16 block tall sections of fake chunks around the nodes it looks at, the rest
+    // of a chunk is generated when something else (raytracing, getChunk, refining) needs it. Disabled by default.
+    public static native void setLazySectionGeneration(long context, boolean enabled);
+
+    // Makes pathFind search from the goal too and stop where the two searches meet. On the open routes it was measured on
+    // it does more work than the normal search. Disabled by default.
+    public static native void setBidirectionalSearch(long context, boolean enabled);
+
+    // Makes pathFind skip the neighbors of big empty cubes that another node reaches at the same step cost, and go
+    // straight through empty space without queueing every cube. This is faster in open space, but the search can end on
+    // a path that costs slightly more (or less) than without it. Disabled by default.
+    public static native void setSymmetryPruning(long context, boolean enabled);
+
+    // Makes pathFind keep its search between calls to the same goal (with the same settings) and only redo the part that
+    // the new start and the chunks that changed since affect, which is much faster when a path is recomputed while
+    // walking it. The paths always reach the goal, the normal search is used when it can't find one in time.
+    // The paths aren't the ones of the normal search and can cost more: on single generated routes with fakeChunkCost 1
+    // it was 7% (3000 blocks) to 20% (500 blocks) more, on others they were cheaper. Disabled by default.
+    public static native void setIncrementalReplanning(long context, boolean enabled);
+
+    // Makes pathFind find a complete path with a very greedy search first and then keep improving it until 500 ms have
+    // passed (or it's the cheapest one). Bidirectional search is ignored with it. Disabled by default.
+    public static native void setAnytimeSearch(long context, boolean enabled);
+
+    // The priority queue of the search: 0 is a binary heap of node pointers (the default), 1 a binary heap that keeps
+    // the costs inline (same paths as 0), 2 a 4-ary heap with inline costs and 3 buckets that only order the nodes to
+    // 1/8 of a block of cost.
+    public static native void setOpenSet(long context, int type);
+
+    // Generates every chunk in the rectangle (inclusive) that isn't in the cache yet on up to the given number of threads of the
+    // context's thread pool (0 for all of them) and blocks until they are all in the cache. cancel stops it early, the chunks that were finished are kept.
+    // Returns the number of chunks that were added.
+    public static native long pregenerate(long context, int minChunkX, int minChunkZ, int maxChunkX, int maxChunkZ, int threads);
+
+    // {chunks added, chunks to generate} of the last or running pregenerate call, can be called from any thread
+    public static native long[] getPregenerationProgress(long context);
+
     public static native PathSegment pathFind(long context, int x1, int y1, int z1, int x2, int y2, int z2, boolean atLeastX4, boolean refine, int failTimeoutInMillis, boolean defaultAirElseGenerate, double fakeChunkCost);
 
     private static native void raytrace0(long context, int fakeChunkMode, int inputs, double[] start, double[] end, boolean[] hitsOut, double[] hitPosOutCanBeNull);
@@ -5,6 +5,8 @@
 
 #include "PathNode.h"
 
+struct PathNodeArena;
+
 // pasted from baritone :-)
 struct BinaryHeapOpenSet {
 private:
@@ -16,6 +18,8 @@ private:
 public:
     explicit BinaryHeapOpenSet(int size): vector(size) {}
     explicit BinaryHeapOpenSet(): BinaryHeapOpenSet(INITIAL_CAPACITY) {}
+    // like the other open sets, this one doesn't need the nodes
+    explicit BinaryHeapOpenSet(PathNodeArena&): BinaryHeapOpenSet() {}
 
 
     [[nodiscard]] int getSize() const {
@@ -46,7 +50,7 @@ public:
     __attribute__((noinline)) void update(PathNode* val) {
         int index = val->heapPosition;
         int parentIndex = unsignedRShift(index, 1);
-        const double cost = val->combinedCost;
+        const float cost = val->combinedCost;
         PathNode* parentNode = vector[parentIndex];
         while (index > 1 && parentNode->combinedCost > cost) {
             this->vector[index] = parentNode;
@@ -73,13 +77,13 @@ public:
         }
         int index = 1;
         int smallerChild = 2;
-        double cost = val->combinedCost;
+        float cost = val->combinedCost;
         do {
             PathNode* smallerChildNode = vector[smallerChild];
-            double smallerChildCost = smallerChildNode->combinedCost;
+            float smallerChildCost = smallerChildNode->combinedCost;
             if (smallerChild < this->size) {
                 PathNode* rightChildNode = vector[smallerChild + 1];
-                double rightChildCost = rightChildNode->combinedCost;
+                float rightChildCost = rightChildNode->combinedCost;
                 if (smallerChildCost > rightChildCost) {
                     smallerChild++;
                     smallerChildCost = rightChildCost;
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <cstdint>
+#include <cassert>
+
+#include "PathNode.h"
+#include "PathNodeArena.h"
+
+// The open nodes in buckets of combinedCost that are 1 / BUCKETS_PER_COST wide, so inserting and updating a node is
+// a push and removeLowest pops the newest node of the lowest bucket. Nodes whose costs are in the same bucket come out
+// in any order, which is the only difference to a heap.
+// A node's heapPosition is its bucket (offset so it is never -1). Updating a node that moves to another bucket leaves
+// its old entry behind and removeLowest skips the entries that don't match the heapPosition of their node.
+// Costs only go down, so a node can't come back to a bucket it left.
+struct BucketOpenSet {
+private:
+    static constexpr float BUCKETS_PER_COST = 8;
+    // more than the number of buckets below 0 a cost in a world can be in
+    static constexpr int KEY_OFFSET = 1 << 29;
+
+    PathNodeArena& nodes;
+    // buckets[i] has key firstKey + i, only the ones from the lowest to the highest key that was used exist
+    std::deque<std::vector<uint32_t>> buckets;
+    int firstKey = 0;
+    // no bucket below this has a live entry
+    size_t lowest = 0;
+    int size = 0;
+
+    static int key(const PathNode* node) {
+        return (int) std::floor(node->combinedCost * BUCKETS_PER_COST) + KEY_OFFSET;
+    }
+
+    void push(PathNode* node) {
+        const int k = key(node);
+        if (this->buckets.empty()) {
+            this->firstKey = k;
+        } else if (k < this->firstKey) {
+            const size_t added = this->firstKey - k;
+            this->buckets.insert(this->buckets.begin(), added, {});
+            this->lowest += added;
+            this->firstKey = k;
+        }
+        const size_t bucket = k - this->firstKey;
+        if (bucket >= this->buckets.size()) {
+            this->buckets.resize(bucket + 1);
+        }
+        this->buckets[bucket].push_back(node->index);
+        this->lowest = std::min(this->lowest, bucket);
+        node->heapPosition = k;
+    }
+
+public:
+    explicit BucketOpenSet(PathNodeArena& nodes): nodes(nodes) {}
+
+    [[nodiscard]] int getSize() const {
+        return this->size;
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return this->size == 0;
+    }
+
+    void insert(PathNode* value) {
+        assert(value != nullptr);
+        this->size++;
+        push(value);
+    }
+
+    // the cost of val can only have gone down
+    void update(PathNode* val) {
+        if (key(val) != val->heapPosition) {
+            push(val);
+        }
+    }
+
+    PathNode* removeLowest() {
+        if (this->size == 0) throw "trolled";
+
+        while (true) {
+            std::vector<uint32_t>& bucket = this->buckets[this->lowest];
+            if (bucket.empty()) {
+                this->lowest++;
+                continue;
+            }
+            PathNode& node = this->nodes[bucket.back()];
+            bucket.pop_back();
+            if (node.heapPosition != this->firstKey + (int) this->lowest) continue;
+            node.heapPosition = -1;
+            this->size--;
+            return &node;
+        }
+    }
+};
@@ -77,6 +77,7 @@ inline bool isEmpty(const T& input) {
 enum class ChunkState : uint8_t {
     FROM_JAVA = 0
     ,FAKE = 1 // could be generated or just air
+    ,PARTIAL = 2 // generated but only the x16 sections in Context::partialSections, these are never compressed
 };
 
 enum class Dimension {
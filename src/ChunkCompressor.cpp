@@ -0,0 +1,181 @@
+#include "ChunkCompressor.h"
+
+enum SectionTag : uint8_t {
+    EMPTY = 0,
+    SOLID = 1,
+    RUNS = 2
+};
+
+CompressedChunk compressChunk(const Chunk& chunk) {
+    CompressedChunk out;
+    for (const x16_t& x16 : chunk.data) {
+        if (isEmpty(x16)) {
+            out.bytes.push_back(SectionTag::EMPTY);
+            continue;
+        }
+        if (memcmp(&x16, &SOLID_CHUNK.data[0], sizeof(x16_t)) == 0) {
+            out.bytes.push_back(SectionTag::SOLID);
+            continue;
+        }
+        out.bytes.push_back(SectionTag::RUNS);
+        auto* bytes = reinterpret_cast<const uint8_t*>(&x16);
+        size_t i = 0;
+        while (i < sizeof(x16_t)) {
+            const uint8_t value = bytes[i];
+            size_t run = 1;
+            while (run < 256 && i + run < sizeof(x16_t) && bytes[i + run] == value) {
+                run++;
+            }
+            out.bytes.push_back(static_cast<uint8_t>(run - 1));
+            out.bytes.push_back(value);
+            i += run;
+        }
+    }
+    out.bytes.shrink_to_fit();
+    return out;
+}
+
+// out must be zeroed (freshly allocated chunks always are)
+void decompressChunk(const CompressedChunk& compressed, Chunk& out) {
+    const uint8_t* in = compressed.bytes.data();
+    for (x16_t& x16 : out.data) {
+        const uint8_t tag = *in++;
+        // don't write zeros, they would commit pages that the page allocator hasn't touched yet
+        if (tag == SectionTag::EMPTY) continue;
+        auto* bytes = reinterpret_cast<uint8_t*>(&x16);
+        if (tag == SectionTag::SOLID) {
+            memset(bytes, 0xFF, sizeof(x16_t));
+            continue;
+        }
+        size_t i = 0;
+        while (i < sizeof(x16_t)) {
+            const size_t run = in[0] + 1;
+            const uint8_t value = in[1];
+            in += 2;
+            memset(bytes + i, value, run);
+            i += run;
+        }
+    }
+}
+
+ChunkCompressor::~ChunkCompressor() {
+    stop();
+}
+
+void ChunkCompressor::setColdTime(std::chrono::milliseconds time) {
+    if (time.count() == 0) {
+        stop();
+    } else if (!thread.joinable()) {
+        stopRequest = false;
+        thread = std::thread([this] { run(); });
+    }
+    coldTime = time;
+}
+
+void ChunkCompressor::stop() {
+    {
+        std::lock_guard lock(mutex);
+        stopRequest = true;
+        jobs.clear();
+        results.clear();
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    pending.clear();
+}
+
+void ChunkCompressor::run() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return stopRequest || !jobs.empty(); });
+        if (stopRequest) return;
+
+        const Job job = jobs.front();
+        jobs.pop_front();
+        results.push_back({job.pos, job.chunk, compressChunk(*job.chunk)});
+    }
+}
+
+Chunk* ChunkCompressor::decompress(const ChunkPos& pos, Allocator<Chunk>& allocator) {
+    auto it = compressed.find(pos);
+    if (it == compressed.end()) return nullptr;
+    Chunk* chunk = allocator.allocate();
+    decompressChunk(it->second, *chunk);
+    totalBytes -= it->second.bytes.size();
+    compressed.erase(it);
+    if (enabled()) {
+        lastAccess.insert_or_assign(pos, clock::now());
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return chunk;
+}
+
+void ChunkCompressor::sync(cache_t& cache, Allocator<Chunk>& allocator) {
+    if (!enabled()) return;
+
+    std::vector<Result> done;
+    {
+        std::lock_guard lock(mutex);
+        done.swap(results);
+    }
+    const auto now = clock::now();
+    for (Result& result : done) {
+        pending.erase(result.pos);
+        auto it = cache.find(result.pos);
+        if (it == cache.end()) continue;
+        auto& [state, chunk] = it->second;
+        if (chunk != result.chunk || state != ChunkState::FAKE || pinned.contains(result.pos)) continue;
+        auto access = lastAccess.find(result.pos);
+        // accessed again while it was being compressed
+        if (access != lastAccess.end() && now - access->second < coldTime) continue;
+
+        allocator.free(chunk);
+        chunk = nullptr;
+        totalBytes += result.data.bytes.size();
+        compressed.insert_or_assign(result.pos, std::move(result.data));
+        lastAccess.erase(result.pos);
+    }
+
+    std::vector<Job> newJobs;
+    for (auto& [pos, entry] : cache) {
+        auto& [state, chunk] = entry;
+        if (state != ChunkState::FAKE || !chunk || pending.contains(pos) || pinned.contains(pos)) continue;
+        auto [access, inserted] = lastAccess.try_emplace(pos, now);
+        // chunks that were never touched (findAir, baritone cache) start aging the first time we see them
+        if (inserted || now - access->second < coldTime) continue;
+
+        pending.emplace(pos, chunk);
+        newJobs.push_back({pos, chunk});
+    }
+    if (!newJobs.empty()) {
+        {
+            std::lock_guard lock(mutex);
+            jobs.insert(jobs.end(), newJobs.begin(), newJobs.end());
+        }
+        condition.notify_one();
+    }
+}
+
+void ChunkCompressor::remove(const ChunkPos& pos) {
+    if (auto it = compressed.find(pos); it != compressed.end()) {
+        totalBytes -= it->second.bytes.size();
+        compressed.erase(it);
+    }
+    lastAccess.erase(pos);
+    pinned.erase(pos);
+    if (pending.erase(pos)) {
+        std::lock_guard lock(mutex);
+        std::erase_if(jobs, [&](const Job& job) { return job.pos == pos; });
+        std::erase_if(results, [&](const Result& result) { return result.pos == pos; });
+    }
+}
+
+void ChunkCompressor::cancelPending() {
+    if (pending.empty()) return;
+    std::lock_guard lock(mutex);
+    jobs.clear();
+    results.clear();
+    pending.clear();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <unordered_set>
+
+#include "Chunk.h"
+#include "ChunkGen.h"
+#include "Allocator.h"
+
+// Run length encoded copy of a chunk.
+// Every x16 is a tag byte (empty, solid or runs) and the runs are (length - 1, value) byte pairs.
+struct CompressedChunk {
+    std::vector<uint8_t> bytes;
+};
+
+CompressedChunk compressChunk(const Chunk& chunk);
+void decompressChunk(const CompressedChunk& compressed, Chunk& out);
+
+// Compresses generated chunks that haven't been accessed for a while.
+// A compressed chunk stays in the cache with a null pointer and gets decompressed by whoever accesses it next.
+// The cache is only modified by the thread that owns the context (in sync/decompress), the background thread only reads chunk data.
+struct ChunkCompressor {
+    using clock = std::chrono::steady_clock;
+
+    std::atomic_uint64_t hits{}; // accesses that found the chunk uncompressed
+    std::atomic_uint64_t misses{}; // accesses that had to decompress the chunk
+
+    ChunkCompressor() = default;
+    ChunkCompressor(const ChunkCompressor&) = delete;
+    ~ChunkCompressor();
+
+    // 0 disables compressing new chunks, already compressed chunks are still decompressed when accessed
+    void setColdTime(std::chrono::milliseconds time);
+    bool enabled() const {
+        return coldTime.count() != 0;
+    }
+
+    void touch(const ChunkPos& pos) {
+        if (!enabled()) return;
+        lastAccess.insert_or_assign(pos, clock::now());
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // replaces a null chunk pointer in the cache, returns null if the chunk was never compressed
+    Chunk* decompress(const ChunkPos& pos, Allocator<Chunk>& allocator);
+
+    // The chunk isn't compressed again until it's removed, its pointer has been handed out to Java
+    void pin(const ChunkPos& pos) {
+        pinned.insert(pos);
+    }
+
+    // Applies finished compressions to the cache and queues up chunks that have gone cold.
+    // Must not be called while anything is holding a reference to a chunk in the cache.
+    void sync(cache_t& cache, Allocator<Chunk>& allocator);
+
+    // Must be called before a chunk pointer in the cache is freed or replaced
+    void remove(const ChunkPos& pos);
+    // Drops every queued job so that any chunk can be freed after this returns
+    void cancelPending();
+    void stop();
+
+    size_t compressedChunks() const {
+        return compressed.size();
+    }
+    size_t compressedBytes() const {
+        return totalBytes;
+    }
+
+private:
+    struct Job {
+        ChunkPos pos;
+        const Chunk* chunk;
+    };
+    struct Result {
+        ChunkPos pos;
+        const Chunk* chunk;
+        CompressedChunk data;
+    };
+
+    std::chrono::milliseconds coldTime{};
+    // owned by the context thread
+    map_t<ChunkPos, clock::time_point> lastAccess;
+    map_t<ChunkPos, const Chunk*> pending;
+    map_t<ChunkPos, CompressedChunk> compressed;
+    std::unordered_set<ChunkPos> pinned;
+    size_t totalBytes = 0;
+
+    // shared with the background thread, which holds the mutex while it compresses a chunk
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    bool stopRequest = false;
+    std::thread thread;
+
+    void run();
+};
@@ -21,3 +21,14 @@ using map_t = std::unordered_map<K, V>;
 using cache_t = map_t<ChunkPos, std::pair<ChunkState, Chunk*>>;
 
 using ChunkGenExec = ParallelExecutor<3>;
+
+// Width of the aligned square tiles of chunks that are generated together.
+// Bigger tiles do less noise work per chunk but generate more chunks that might never be needed.
+constexpr int GEN_TILE_SIZE = 2;
+
+// the nether generator only fills the bottom 8 x16 sections (128 blocks)
+constexpr int GEN_SECTIONS = 8;
+
+inline ChunkPos tileOf(const ChunkPos& pos) {
+    return {pos.x & -GEN_TILE_SIZE, pos.z & -GEN_TILE_SIZE};
+}
@@ -3,6 +3,115 @@
 #include <cmath>
 #include <cassert>
 #include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+    // 4 doubles (one per lattice cell along z), this is 2 sse2 registers or 1 avx register
+    using double4 = double __attribute__((vector_size(4 * sizeof(double))));
+    using long4 = int64_t __attribute__((vector_size(4 * sizeof(int64_t))));
+
+    constexpr int LAVA_LEVEL = 64 / 2 + 1; // every block below this is lava
+
+    // bit k of the result is whether lane k is positive
+    inline int positiveMask(double4 v) {
+        const long4 m = v > double4{};
+        return (m[0] & 1) | (m[1] & 2) | (m[2] & 4) | (m[3] & 8);
+    }
+
+    // moves bit k to bit 4k
+    constexpr auto SPREAD4 = [] {
+        std::array<uint16_t, 16> out{};
+        for (int m = 0; m < 16; m++) {
+            for (int k = 0; k < 4; k++) {
+                if (m & (1 << k)) out[m] |= 1 << (4 * k);
+            }
+        }
+        return out;
+    }();
+
+    // Positions of the 4 blocks of a z row of an x4 in its 64 bit value (8 x2 bytes indexed by x2Index).
+    // Bit (x, y, z) is 32 * (x & 2) / 2 + 16 * (y & 2) / 2 + 8 * (z & 2) / 2 + bitIndex(x, y, z).
+    inline uint64_t x4Row(int zBits, int x, int y) {
+        const uint64_t row = (zBits & 3) | ((zBits & 12) << 6);
+        return row << (((x & 2) << 4) | ((x & 1) << 2) | ((y & 2) << 3) | ((y & 1) << 1));
+    }
+
+    inline void orX4(Chunk& primer, int x, int y, int z, uint64_t bits) {
+        // bitset defaults to air so writing 0 to it is pointless
+        if (bits == 0) return;
+        x4_t& x4 = primer.data[x16Index(y)][x8Index(x, y, z)][x4Index(x, y, z)];
+        uint64_t current;
+        memcpy(&current, &x4, sizeof(current));
+        current |= bits;
+        memcpy(&x4, &current, sizeof(current));
+    }
+
+    // chunks of a tile that are generated from one noise evaluation
+    struct TileArea {
+        int x, z;
+        int xChunks, zChunks;
+        std::vector<Chunk*> chunks; // indexed like generateChunks
+    };
+
+    // How generateTile splits the non null chunks of a tile: their bounding box if that needs less noise than
+    // generating them one at a time, otherwise every chunk on its own.
+    std::vector<TileArea> tileAreas(int x, int z, int size, Chunk* const* chunks) {
+        int minX = size, minZ = size, maxX = -1, maxZ = -1, missing = 0;
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if (!chunks[i * size + j]) continue;
+                minX = std::min(minX, i); maxX = std::max(maxX, i);
+                minZ = std::min(minZ, j); maxZ = std::max(maxZ, j);
+                missing++;
+            }
+        }
+        if (missing == 0) return {};
+
+        // a tile of w * h chunks needs (4w + 1) * (4h + 1) noise columns and a single chunk needs 25
+        const int xChunks = maxX - minX + 1;
+        const int zChunks = maxZ - minZ + 1;
+        std::vector<TileArea> out;
+        if ((xChunks * 4 + 1) * (zChunks * 4 + 1) < missing * 25) {
+            TileArea& area = out.emplace_back(TileArea{x + minX, z + minZ, xChunks, zChunks});
+            for (int i = 0; i < xChunks; i++) {
+                for (int j = 0; j < zChunks; j++) {
+                    area.chunks.push_back(chunks[(minX + i) * size + minZ + j]);
+                }
+            }
+        } else {
+            for (int i = 0; i < size * size; i++) {
+                if (chunks[i]) out.push_back({x + i / size, z + i % size, 1, 1, {chunks[i]}});
+            }
+        }
+        return out;
+    }
+
+    // Fills the sections that are entirely lava (they don't need any noise) and returns the first one that isn't
+    int fillLavaSections(Chunk* const* chunks, int count, int minSection, int maxSection) {
+        for (int section = minSection; section <= maxSection && section * 16 + 15 < LAVA_LEVEL; section++) {
+            for (int i = 0; i < count; i++) {
+                if (chunks[i]) memset(&chunks[i]->data[section], 0xFF, sizeof(x16_t));
+            }
+            minSection = section + 1;
+        }
+        return minSection;
+    }
+
+    // the interpolation of generateChunks, buffer has cells + 1 values for every lattice column of the area
+    void interpolateChunks(const double* buffer, int xChunks, int zChunks, Chunk* const* chunks, int firstCell, int cells) {
+        const int zColumns = zChunks * 4 + 1;
+        for (int i = 0; i < xChunks; i++) {
+            for (int j = 0; j < zChunks; j++) {
+                Chunk* chunk = chunks[i * zChunks + j];
+                if (chunk) {
+                    ChunkGeneratorHell::interpolateChunk(&buffer[(i * 4 * zColumns + j * 4) * (cells + 1)], zColumns, *chunk, firstCell, cells);
+                }
+            }
+        }
+    }
+}
 
 void ChunkGeneratorHell::generateChunk(int x, int z, Chunk& chunkprimer, ChunkGenExec& threadPool) const {
     prepareHeights(x, z, chunkprimer, threadPool);
@@ -15,9 +124,370 @@ Chunk ChunkGeneratorHell::generateChunk(int x, int z, ChunkGenExec& threadPool)
     return chunkprimer;
 }
 
+void ChunkGeneratorHell::generateChunks(int x, int z, int xChunks, int zChunks, Chunk* const* chunks, ChunkGenExec& threadPool, int minSection, int maxSection) const {
+    minSection = fillLavaSections(chunks, xChunks * zChunks, minSection, maxSection);
+    if (minSection > maxSection) return;
+
+    const int xColumns = xChunks * 4 + 1;
+    const int zColumns = zChunks * 4 + 1;
+    // every section is 2 lattice cells tall
+    const int firstCell = minSection * 2;
+    const int cells = (maxSection - minSection + 1) * 2;
+    const std::vector buffer = this->getHeights<17>(x * 4, 0, z * 4, xColumns, zColumns, threadPool, firstCell, cells + 1);
+    interpolateChunks(buffer.data(), xChunks, zChunks, chunks, firstCell, cells);
+}
+
+void ChunkGeneratorHell::generateTile(int x, int z, int size, Chunk* const* chunks, ChunkGenExec& threadPool, int minSection, int maxSection) const {
+    const bool whole = minSection == 0 && maxSection == GEN_SECTIONS - 1;
+    for (const TileArea& area : tileAreas(x, z, size, chunks)) {
+        if (whole && area.chunks.size() == 1) {
+            generateChunk(area.x, area.z, *area.chunks[0], threadPool);
+        } else {
+            generateChunks(area.x, area.z, area.xChunks, area.zChunks, area.chunks.data(), threadPool, minSection, maxSection);
+        }
+    }
+}
+
+void ChunkGeneratorHell::generateTiles(std::span<const TileRequest> tiles, ChunkGenExec& threadPool) const {
+    if (this->columnCache.enabled()) {
+        // the cache has its own way of getting the noise, the tiles just run at the same time
+        threadPool.forEach((int) tiles.size(), [&](int i) {
+            const TileRequest& tile = tiles[i];
+            generateTile(tile.x, tile.z, tile.size, tile.chunks, threadPool, tile.minSection, tile.maxSection);
+        });
+        return;
+    }
+
+    struct Area {
+        TileArea area;
+        int firstCell, cells;
+        std::vector<double> pnr, ar, br;
+    };
+    std::vector<Area> areas;
+    for (const TileRequest& tile : tiles) {
+        for (TileArea& area : tileAreas(tile.x, tile.z, tile.size, tile.chunks)) {
+            const int minSection = fillLavaSections(area.chunks.data(), (int) area.chunks.size(), tile.minSection, tile.maxSection);
+            if (minSection > tile.maxSection) continue;
+            // every section is 2 lattice cells tall
+            areas.push_back({std::move(area), minSection * 2, (tile.maxSection - minSection + 1) * 2});
+        }
+    }
+    std::vector<NoiseBox> boxes;
+    for (Area& a : areas) {
+        const int xColumns = a.area.xChunks * 4 + 1;
+        const int zColumns = a.area.zChunks * 4 + 1;
+        const size_t size = (size_t) xColumns * zColumns * (a.cells + 1);
+        a.pnr.resize(size);
+        a.ar.resize(size);
+        a.br.resize(size);
+        boxes.push_back({a.area.x * 4, 0, a.area.z * 4, xColumns, a.cells + 1, zColumns, 0, a.firstCell, 0, {a.pnr.data(), a.ar.data(), a.br.data()}});
+    }
+
+    // the octaves of every box are spread over the jobs like they are over 3 for one box, and each area is interpolated
+    // by the job that finishes its noise so the caller only waits once
+    constexpr int MAX_TASKS = 12;
+    generateNoise(boxes, threadPool, std::min(MAX_TASKS, 3 * (int) boxes.size()), [&](size_t i) {
+        const Area& a = areas[i];
+        const int columns = (a.area.xChunks * 4 + 1) * (a.area.zChunks * 4 + 1);
+        std::vector<double> buffer(a.pnr.size());
+        noiseToHeights<17>(buffer.data(), a.pnr.data(), a.ar.data(), a.br.data(), columns, a.firstCell, a.cells + 1);
+        interpolateChunks(buffer.data(), a.area.xChunks, a.area.zChunks, a.area.chunks.data(), a.firstCell, a.cells);
+    });
+}
+
 void ChunkGeneratorHell::prepareHeights(int x, int z, Chunk& primer, ChunkGenExec& threadPool) const {
-    const std::array buffer = this->getHeights<5, 17, 5>(x * 4, 0, z * 4, threadPool);
+    if (this->columnCache.enabled()) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::array buffer = this->getHeightsCached(x, z, threadPool);
+        interpolateChunk(buffer.data(), 5, primer);
+        const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        this->columnCache.generateNanos.fetch_add(nanos, std::memory_order_relaxed);
+        this->columnCache.generatedChunks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // this skips the noise below the lava level
+    Chunk* chunk = &primer;
+    generateChunks(x, z, 1, 1, &chunk, threadPool);
+}
+
+void ChunkGeneratorHell::generateNoise(std::span<const NoiseBox> boxes, ChunkGenExec& threadPool) const {
+    generateNoise(boxes, threadPool, 3, nullptr);
+}
+
+void ChunkGeneratorHell::generateNoise(std::span<const NoiseBox> boxes, ChunkGenExec& threadPool, int tasks, const std::function<void(size_t)>& done) const {
+    struct Generator {
+        const NoiseGeneratorOctavesBase& noise;
+        double xzScale;
+        double yScale;
+        int out; // index in NoiseBox::out
+    };
+    // in this order the 40 octaves of a box split into 13/13/14 with the fewest generators shared between threads
+    const std::array<Generator, 3> generators{{
+        {this->lperlinNoise1, 684.412, 2053.236, 1},
+        {this->lperlinNoise2, 684.412, 2053.236, 2},
+        {this->perlinNoise1, 8.555150000000001, 34.2206, 0}
+    }};
+
+    // Every octave of every box is a job and each thread gets a contiguous range of them.
+    // The thread that has octave 0 of a generator adds its octaves to the output in order like generateNoiseOctaves,
+    // the rest are computed into their own zeroed scratch arrays which are added to the output in order afterwards.
+    struct Run {
+        const NoiseBox& box;
+        const Generator& generator;
+        int firstJob;
+        int direct; // octaves [0, direct) are added to the output directly
+        size_t scratch; // where octave direct goes in scratch
+    };
+    std::vector<Run> runs;
+    int jobs = 0;
+    for (const NoiseBox& box : boxes) {
+        for (const Generator& generator : generators) {
+            runs.push_back({box, generator, jobs});
+            jobs += (int) generator.noise.octaves;
+        }
+    }
+    auto taskBegin = [jobs, tasks](int task) {
+        return jobs * task / tasks;
+    };
+    size_t scratchSize = 0;
+    for (Run& run : runs) {
+        const int octaves = (int) run.generator.noise.octaves;
+        int task = 0;
+        while (taskBegin(task + 1) <= run.firstJob) task++;
+        run.direct = std::min(taskBegin(task + 1) - run.firstJob, octaves);
+        run.scratch = scratchSize;
+        scratchSize += (size_t) (octaves - run.direct) * run.box.xSize * run.box.ySize * run.box.zSize;
+    }
+    std::vector<double> scratch(scratchSize);
+
+    // the tasks that still have octaves of each box, the last one of them finishes the box
+    int boxJobs = 0;
+    for (const Generator& generator : generators) {
+        boxJobs += (int) generator.noise.octaves;
+    }
+    std::unique_ptr<std::atomic_int[]> remaining(new std::atomic_int[boxes.size()]);
+    for (size_t b = 0; b < boxes.size(); b++) {
+        int touching = 0;
+        for (int t = 0; t < tasks; t++) {
+            touching += taskBegin(t) < (int) (b + 1) * boxJobs && taskBegin(t + 1) > (int) b * boxJobs;
+        }
+        remaining[b].store(touching, std::memory_order_relaxed);
+    }
+    auto finishBox = [&](size_t b) {
+        for (size_t r = b * generators.size(); r < (b + 1) * generators.size(); r++) {
+            const Run& run = runs[r];
+            const size_t size = (size_t) run.box.xSize * run.box.ySize * run.box.zSize;
+            double* out = run.box.out[run.generator.out];
+            for (int octave = run.direct; octave < (int) run.generator.noise.octaves; octave++) {
+                const double* values = &scratch[run.scratch + (octave - run.direct) * size];
+                for (size_t i = 0; i < size; i++) {
+                    out[i] += values[i];
+                }
+            }
+        }
+        if (done) done(b);
+    };
+
+    threadPool.forEach(tasks, [&](int index) {
+        for (size_t b = 0; b < boxes.size(); b++) {
+            bool touched = false;
+            for (size_t r = b * generators.size(); r < (b + 1) * generators.size(); r++) {
+                const Run& run = runs[r];
+                const NoiseBox& box = run.box;
+                const Generator& generator = run.generator;
+                const size_t size = (size_t) box.xSize * box.ySize * box.zSize;
+                const int first = std::max(taskBegin(index) - run.firstJob, 0);
+                const int last = std::min(taskBegin(index + 1) - run.firstJob, (int) generator.noise.octaves);
+                for (int octave = first; octave < last; octave++) {
+                    double* out = octave < run.direct ? box.out[generator.out] : &scratch[run.scratch + (octave - run.direct) * size];
+                    generator.noise.populateOctave(out, octave, box.xOffset, box.yOffset, box.zOffset, box.xSize, box.ySize, box.zSize,
+                        generator.xzScale, generator.yScale, generator.xzScale, box.xStart, box.yStart, box.zStart);
+                }
+                touched |= first < last;
+            }
+            if (touched && remaining[b].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finishBox(b);
+            }
+        }
+    });
+}
+
+// Every lattice column is computed as part of the chunk that has it in its first 4x4 columns (the chunk that "owns" it),
+// so a column always has the same value no matter which chunk asked for it first.
+// The first 4x4 columns of a chunk are exactly what getHeights<5, 17, 5> would return, and the 9 on the
+// far edges are what the neighbours would compute for them.
+std::array<double, 5 * 17 * 5> ChunkGeneratorHell::getHeightsCached(int x, int z, ChunkGenExec& threadPool) const {
+    constexpr int Y = NoiseColumnCache::Y_SIZE;
+    // the columns of this chunk that belong to one owner
+    struct Group {
+        int chunkX, chunkZ; // owner
+        int x0, z0; // first column in this chunk
+        int xSize, zSize;
+        // bounding box of the missing columns, relative to the owner
+        int xStart = 4, zStart = 4, xEnd = -1, zEnd = -1;
+    };
+    std::array<Group, 4> groups{{
+        {x, z, 0, 0, 4, 4},
+        {x + 1, z, 4, 0, 1, 4},
+        {x, z + 1, 0, 4, 4, 1},
+        {x + 1, z + 1, 4, 4, 1, 1}
+    }};
+    std::array<double, 5 * Y * 5> buffer;
+    std::array<Group*, 4> missing{};
+    int numMissing = 0;
+    uint64_t hits = 0, misses = 0;
+    for (Group& g : groups) {
+        for (int i = 0; i < g.xSize; i++) {
+            for (int j = 0; j < g.zSize; j++) {
+                if (this->columnCache.get(x * 4 + g.x0 + i, z * 4 + g.z0 + j, &buffer[((g.x0 + i) * 5 + g.z0 + j) * Y])) {
+                    hits++;
+                    continue;
+                }
+                misses++;
+                const int ownerX = (g.x0 + i) & 3;
+                const int ownerZ = (g.z0 + j) & 3;
+                g.xStart = std::min(g.xStart, ownerX); g.xEnd = std::max(g.xEnd, ownerX);
+                g.zStart = std::min(g.zStart, ownerZ); g.zEnd = std::max(g.zEnd, ownerZ);
+            }
+        }
+        if (g.xEnd != -1) missing[numMissing++] = &g;
+    }
+    this->columnCache.hits.fetch_add(hits, std::memory_order_relaxed);
+    this->columnCache.misses.fetch_add(misses, std::memory_order_relaxed);
+    if (numMissing == 0) return buffer;
+
+    // the noise of the bounding box of every group with missing columns, in the same order as missing
+    std::array<std::array<std::vector<double>, 3>, 4> noise;
+    std::array<NoiseBox, 4> boxes;
+    for (int i = 0; i < numMissing; i++) {
+        const Group& g = *missing[i];
+        const int xSize = g.xEnd - g.xStart + 1;
+        const int zSize = g.zEnd - g.zStart + 1;
+        for (std::vector<double>& values : noise[i]) {
+            values.resize(xSize * Y * zSize);
+        }
+        boxes[i] = {g.chunkX * 4, 0, g.chunkZ * 4, xSize, Y, zSize, g.xStart, 0, g.zStart, {noise[i][0].data(), noise[i][1].data(), noise[i][2].data()}};
+    }
+    generateNoise({boxes.data(), (size_t) numMissing}, threadPool);
+
+    std::vector<double> heights;
+    for (int n = 0; n < numMissing; n++) {
+        const Group& g = *missing[n];
+        const int xSize = g.xEnd - g.xStart + 1;
+        const int zSize = g.zEnd - g.zStart + 1;
+        heights.resize(xSize * Y * zSize);
+        noiseToHeights<Y>(heights.data(), noise[n][0].data(), noise[n][1].data(), noise[n][2].data(), xSize * zSize);
+        for (int i = 0; i < xSize; i++) {
+            for (int j = 0; j < zSize; j++) {
+                const double* column = &heights[(i * zSize + j) * Y];
+                // position in this chunk, the bounding box can include cached columns but they have the same value
+                const int cx = g.x0 + g.xStart + i;
+                const int cz = g.z0 + g.zStart + j;
+                std::copy(column, column + Y, &buffer[(cx * 5 + cz) * Y]);
+                this->columnCache.put(x * 4 + cx, z * 4 + cz, column);
+            }
+        }
+    }
+    return buffer;
+}
+
+// Same result as interpolateChunkScalar, but the 4 lattice cells along z are interpolated together and every
+// x4 is built in a register and written once instead of calling setBlock for every solid block.
+// The values are computed with the exact same operations in the same order as the scalar code so they are bit identical.
+// Cells that are below the lava level, or whose corners all have the same sign by a wide margin, are filled without interpolating.
+void ChunkGeneratorHell::interpolateChunk(const double* buffer, int zColumns, Chunk& primer, int firstCell, int cells) {
+    auto column = [&](int x, int z) {
+        return &buffer[(x * zColumns + z) * (cells + 1)];
+    };
+
+    for (int j1 = 0; j1 < 4; ++j1)
+    {
+        for (int l1 = firstCell; l1 < firstCell + cells; ++l1)
+        {
+            // x4s of this cell, indexed by the upper/lower half of the cell and the z cell
+            uint64_t words[2][4]{};
+
+            double4 c1, c2, c3, c4, n1, n2, n3, n4;
+            for (int k1 = 0; k1 < 4; ++k1) {
+                c1[k1] = column(j1 + 0, k1 + 0)[l1 - firstCell]; n1[k1] = column(j1 + 0, k1 + 0)[l1 - firstCell + 1];
+                c2[k1] = column(j1 + 0, k1 + 1)[l1 - firstCell]; n2[k1] = column(j1 + 0, k1 + 1)[l1 - firstCell + 1];
+                c3[k1] = column(j1 + 1, k1 + 0)[l1 - firstCell]; n3[k1] = column(j1 + 1, k1 + 0)[l1 - firstCell + 1];
+                c4[k1] = column(j1 + 1, k1 + 1)[l1 - firstCell]; n4[k1] = column(j1 + 1, k1 + 1)[l1 - firstCell + 1];
+            }
+
+            bool constant = true;
+            if (l1 * 8 + 7 < LAVA_LEVEL) {
+                for (auto& half : words) std::fill(std::begin(half), std::end(half), ~0ull);
+            } else {
+                for (int k1 = 0; k1 < 4; ++k1) {
+                    const double corners[] = {c1[k1], c2[k1], c3[k1], c4[k1], n1[k1], n2[k1], n3[k1], n4[k1]};
+                    const auto [min, max] = std::minmax_element(std::begin(corners), std::end(corners));
+                    // the rounding error of the interpolation is a few ulps of the biggest corner, this is far more than that
+                    const double margin = std::max(*max, -*min) * 0x1p-30;
+                    if (*min > margin) {
+                        words[0][k1] = words[1][k1] = ~0ull;
+                    } else if (!(*max < -margin && l1 * 8 >= LAVA_LEVEL)) {
+                        constant = false;
+                    }
+                }
+            }
+
+            if (!constant) {
+                double4 d1 = c1;
+                double4 d2 = c2;
+                double4 d3 = c3;
+                double4 d4 = c4;
+                const double4 d5 = (n1 - d1) * 0.125;
+                const double4 d6 = (n2 - d2) * 0.125;
+                const double4 d7 = (n3 - d3) * 0.125;
+                const double4 d8 = (n4 - d4) * 0.125;
+
+                for (int i2 = 0; i2 < 8; ++i2)
+                {
+                    const int y = l1 * 8 + i2;
+                    double4 d10 = d1;
+                    double4 d11 = d2;
+                    const double4 d12 = (d3 - d1) * 0.25;
+                    const double4 d13 = (d4 - d2) * 0.25;
+
+                    for (int j2 = 0; j2 < 4; ++j2)
+                    {
+                        double4 d15 = d10;
+                        const double4 d16 = (d11 - d10) * 0.25;
+                        // bit k2 + 4 * k1 is block z = k2 + k1 * 4 of this row
+                        int zBits = 0;
+                        for (int k2 = 0; k2 < 4; ++k2)
+                        {
+                            zBits |= SPREAD4[positiveMask(d15)] << k2;
+                            d15 += d16;
+                        }
+                        if (y < LAVA_LEVEL) zBits = 0xFFFF;
+
+                        for (int k1 = 0; k1 < 4; ++k1) {
+                            words[i2 >> 2][k1] |= x4Row(zBits >> (k1 * 4), j2, i2);
+                        }
+
+                        d10 += d12;
+                        d11 += d13;
+                    }
+
+                    d1 += d5;
+                    d2 += d6;
+                    d3 += d7;
+                    d4 += d8;
+                }
+            }
+
+            for (int h = 0; h < 2; h++) {
+                for (int k1 = 0; k1 < 4; k1++) {
+                    orX4(primer, j1 * 4, l1 * 8 + h * 4, k1 * 4, words[h][k1]);
+                }
+            }
+        }
+    }
+}
 
+void ChunkGeneratorHell::interpolateChunkScalar(const double* buffer, int zColumns, Chunk& primer) {
     constexpr auto j = 64 / 2 + 1; // 64 = sea level
 
     for (int j1 = 0; j1 < 4; ++j1)
@@ -26,14 +496,14 @@ void ChunkGeneratorHell::prepareHeights(int x, int z, Chunk& primer, ChunkGenExe
         {
             for (int l1 = 0; l1 < 16; ++l1)
             {
-                double d1 = buffer[((j1 + 0) * 5 + k1 + 0) * 17 + l1 + 0];
-                double d2 = buffer[((j1 + 0) * 5 + k1 + 1) * 17 + l1 + 0];
-                double d3 = buffer[((j1 + 1) * 5 + k1 + 0) * 17 + l1 + 0];
-                double d4 = buffer[((j1 + 1) * 5 + k1 + 1) * 17 + l1 + 0];
-                const double d5 = (buffer[((j1 + 0) * 5 + k1 + 0) * 17 + l1 + 1] - d1) * 0.125;
-                const double d6 = (buffer[((j1 + 0) * 5 + k1 + 1) * 17 + l1 + 1] - d2) * 0.125;
-                const double d7 = (buffer[((j1 + 1) * 5 + k1 + 0) * 17 + l1 + 1] - d3) * 0.125;
-                const double d8 = (buffer[((j1 + 1) * 5 + k1 + 1) * 17 + l1 + 1] - d4) * 0.125;
+                double d1 = buffer[((j1 + 0) * zColumns + k1 + 0) * 17 + l1 + 0];
+                double d2 = buffer[((j1 + 0) * zColumns + k1 + 1) * 17 + l1 + 0];
+                double d3 = buffer[((j1 + 1) * zColumns + k1 + 0) * 17 + l1 + 0];
+                double d4 = buffer[((j1 + 1) * zColumns + k1 + 1) * 17 + l1 + 0];
+                const double d5 = (buffer[((j1 + 0) * zColumns + k1 + 0) * 17 + l1 + 1] - d1) * 0.125;
+                const double d6 = (buffer[((j1 + 0) * zColumns + k1 + 1) * 17 + l1 + 1] - d2) * 0.125;
+                const double d7 = (buffer[((j1 + 1) * zColumns + k1 + 0) * 17 + l1 + 1] - d3) * 0.125;
+                const double d8 = (buffer[((j1 + 1) * zColumns + k1 + 1) * 17 + l1 + 1] - d4) * 0.125;
 
                 for (int i2 = 0; i2 < 8; ++i2)
                 {
@@ -4,11 +4,15 @@
 #include <numbers>
 #include <chrono>
 #include <iostream>
+#include <vector>
+#include <span>
+#include <functional>
 
 #include "NoiseGeneratorOctaves.h"
 #include "Chunk.h"
 #include "ParallelExecutor.h"
 #include "ChunkGen.h"
+#include "NoiseColumnCache.h"
 
 struct ChunkGeneratorHell {
 public:
@@ -16,12 +20,40 @@ public:
     NoiseGeneratorOctaves<16> lperlinNoise1;
     NoiseGeneratorOctaves<16> lperlinNoise2;
     NoiseGeneratorOctaves<8>  perlinNoise1;
+    // disabled by default, the noise generators are never modified so this is the only state that changes
+    mutable NoiseColumnCache columnCache;
 
     void prepareHeights(int x, int z, Chunk& primer, ChunkGenExec& threadPool) const;
+    std::array<double, 5 * 17 * 5> getHeightsCached(int x, int z, ChunkGenExec& threadPool) const;
+    // buffer points at the first lattice column of the chunk in a buffer that is zColumns lattice columns wide.
+    // Only the y cells [firstCell, firstCell + cells) are interpolated, the columns in buffer start at firstCell and have cells + 1 values.
+    static void interpolateChunk(const double* buffer, int zColumns, Chunk& primer, int firstCell = 0, int cells = 16);
+    // the original block at a time version, interpolateChunk must match it exactly
+    static void interpolateChunkScalar(const double* buffer, int zColumns, Chunk& primer);
+
+    // a box of lattice points like the arguments of generateNoiseOctaves
+    struct NoiseBox {
+        int xOffset, yOffset, zOffset;
+        int xSize, ySize, zSize;
+        int xStart, yStart, zStart;
+        // where the noise of perlinNoise1, lperlinNoise1 and lperlinNoise2 goes, xSize * ySize * zSize zeroed values each
+        std::array<double*, 3> out;
+    };
+    // Computes the noise of every box exactly like generateNoiseOctaves.
+    // The octaves are split evenly across the executor instead of giving each thread one generator, perlinNoise1 only has half as many.
+    void generateNoise(std::span<const NoiseBox> boxes, ChunkGenExec& threadPool) const;
+    // generateNoise split into tasks jobs that calls done(i) as soon as the noise of boxes[i] is finished,
+    // from the job that finished it (so possibly on another thread and at the same time as other boxes)
+    void generateNoise(std::span<const NoiseBox> boxes, ChunkGenExec& threadPool, int tasks, const std::function<void(size_t)>& done) const;
 
     // buffer may be null
     template<int xSize, int ySize, int zSize>
     std::array<double, xSize * ySize * zSize> getHeights(int xOffset, int yOffset, int zOffset, ChunkGenExec& threadPool) const;
+    // only the ySamples y values starting at yStart of every column are computed
+    template<int ySize>
+    std::vector<double> getHeights(int xOffset, int yOffset, int zOffset, int xSize, int zSize, ChunkGenExec& threadPool, int yStart = 0, int ySamples = ySize) const;
+    template<int ySize>
+    static void noiseToHeights(double* buffer, const double* pnr, const double* ar, const double* br, int columns, int yStart = 0, int ySamples = ySize);
 public:
 
     static ChunkGeneratorHell fromSeed(uint64_t seed) {
@@ -36,6 +68,25 @@ public:
 
     void generateChunk(int x, int z, Chunk& chunkPrimer, ChunkGenExec& threadPool) const;
     Chunk generateChunk(int x, int z, ChunkGenExec& threadPool) const;
+    // Generates the xChunks * zChunks chunks starting at x, z from one noise evaluation.
+    // Neighbouring chunks share their edge lattice columns so this does less noise work than generating them one at a time.
+    // chunks[i * zChunks + j] is chunk (x + i, z + j), null chunks are skipped (but still pay for their noise).
+    // The lattice coordinates are computed from the corner of the tile so the noise can differ from generateChunk
+    // in the last bit, but that has never been seen to change a block.
+    // Only the x16 sections [minSection, maxSection] are generated, the rest of the chunks is left alone.
+    void generateChunks(int x, int z, int xChunks, int zChunks, Chunk* const* chunks, ChunkGenExec& threadPool, int minSection = 0, int maxSection = GEN_SECTIONS - 1) const;
+    // Generates the non null chunks of the size * size tile at x, z (indexed like generateChunks).
+    // They share their noise if that is less work than generating them one at a time.
+    void generateTile(int x, int z, int size, Chunk* const* chunks, ChunkGenExec& threadPool, int minSection = 0, int maxSection = GEN_SECTIONS - 1) const;
+    // the arguments of one generateTile
+    struct TileRequest {
+        int x, z, size;
+        Chunk* const* chunks;
+        int minSection, maxSection;
+    };
+    // generateTile for every tile as one flat batch: the noise of all of them is split into up to 12 jobs and each chunk
+    // is interpolated by the job that finished its noise, so there is a single wait instead of one per tile and generator.
+    void generateTiles(std::span<const TileRequest> tiles, ChunkGenExec& threadPool) const;
 };
 
 // This is only instantiated once
@@ -49,18 +100,29 @@ std::array<double, xSize * ySize * zSize> ChunkGeneratorHell::getHeights(int xOf
     auto ar =      this->lperlinNoise1.generateNoiseOctaves<xSize, ySize, zSize>(xOffset, yOffset, zOffset, 684.412, 2053.236, 684.412); // 105us
     auto br =      this->lperlinNoise2.generateNoiseOctaves<xSize, ySize, zSize>(xOffset, yOffset, zOffset, 684.412, 2053.236, 684.412); // 105us*/
 
-    auto [pnr, ar, br] = threadPool.compute(
-        [=, this] {
-            return this->perlinNoise1.generateNoiseOctaves<xSize, ySize, zSize>(xOffset, yOffset, zOffset, 8.555150000000001, 34.2206, 8.555150000000001);
-        },
-        [=, this] {
-            return this->lperlinNoise1.generateNoiseOctaves<xSize, ySize, zSize>(xOffset, yOffset, zOffset, 684.412, 2053.236, 684.412);
-        },
-        [=, this] {
-            return this->lperlinNoise2.generateNoiseOctaves<xSize, ySize, zSize>(xOffset, yOffset, zOffset, 684.412, 2053.236, 684.412);
-        }
-    );
+    std::array<double, xSize * ySize * zSize> pnr{}, ar{}, br{};
+    const NoiseBox box{xOffset, yOffset, zOffset, xSize, ySize, zSize, 0, 0, 0, {pnr.data(), ar.data(), br.data()}};
+    generateNoise({&box, 1}, threadPool);
+
+    noiseToHeights<ySize>(buffer.data(), pnr.data(), ar.data(), br.data(), xSize * zSize);
+
+    return buffer;
+}
+
+template<int ySize>
+std::vector<double> ChunkGeneratorHell::getHeights(int xOffset, int yOffset, int zOffset, int xSize, int zSize, ChunkGenExec& threadPool, int yStart, int ySamples) const {
+    std::vector<double> buffer(xSize * ySamples * zSize);
+
+    std::vector<double> pnr(buffer.size()), ar(buffer.size()), br(buffer.size());
+    const NoiseBox box{xOffset, yOffset, zOffset, xSize, ySamples, zSize, 0, yStart, 0, {pnr.data(), ar.data(), br.data()}};
+    generateNoise({&box, 1}, threadPool);
+    noiseToHeights<ySize>(buffer.data(), pnr.data(), ar.data(), br.data(), xSize * zSize, yStart, ySamples);
 
+    return buffer;
+}
+
+template<int ySize>
+void ChunkGeneratorHell::noiseToHeights(double* buffer, const double* pnr, const double* ar, const double* br, int columns, int yStart, int ySamples) {
     int i = 0;
     double adouble[ySize];
 
@@ -81,51 +143,45 @@ std::array<double, xSize * ySize * zSize> ChunkGeneratorHell::getHeights(int xOf
         }
     }
 
-    for (int l = 0; l < xSize; ++l)
+    for (int l = 0; l < columns; ++l)
     {
-        for (int i1 = 0; i1 < zSize; ++i1)
+        for (int k = yStart; k < yStart + ySamples; ++k)
         {
-            for (int k = 0; k < ySize; ++k)
+            const double d4 = adouble[k];
+            const double d5 = ar[i] / 512.0;
+            const double d6 = br[i] / 512.0;
+            const double d7 = (pnr[i] / 10.0 + 1.0) / 2.0;
+            double d8;
+
+            if (d7 < 0.0)
             {
-                const double d4 = adouble[k];
-                const double d5 = ar[i] / 512.0;
-                const double d6 = br[i] / 512.0;
-                const double d7 = (pnr[i] / 10.0 + 1.0) / 2.0;
-                double d8;
-
-                if (d7 < 0.0)
-                {
-                    d8 = d5;
-                }
-                else if (d7 > 1.0)
-                {
-                    d8 = d6;
-                }
-                else
-                {
-                    d8 = d5 + (d6 - d5) * d7;
-                }
-
-                d8 = d8 - d4;
-
-                if (k > ySize - 4)
-                {
-                    double d9 = (double)((float)(k - (ySize - 4)) / 3.0F);
-                    d8 = d8 * (1.0 - d9) + -10.0 * d9;
-                }
-
-                if ((double)k < 0.0)
-                {
-                    double d10 = (0.0 - (double)k) / 4.0;
-                    d10 = std::clamp(d10, 0.0, 1.0);
-                    d8 = d8 * (1.0 - d10) + -10.0 * d10;
-                }
-
-                buffer[i] = d8;
-                ++i;
+                d8 = d5;
+            }
+            else if (d7 > 1.0)
+            {
+                d8 = d6;
+            }
+            else
+            {
+                d8 = d5 + (d6 - d5) * d7;
             }
-        }
-    }
 
-    return buffer;
-}
\ No newline at end of file
+            d8 = d8 - d4;
+
+            if (k > ySize - 4)
+            {
+                double d9 = (double)((float)(k - (ySize - 4)) / 3.0F);
+                d8 = d8 * (1.0 - d9) + -10.0 * d9;
+            }
+
+            if ((double)k < 0.0)
+            {
+                double d10 = (0.0 - (double)k) / 4.0;
+                d10 = std::clamp(d10, 0.0, 1.0);
+                d8 = d8 * (1.0 - d10) + -10.0 * d10;
+            }
+
+            buffer[i] = d8;
+            ++i;
+        }
+    }}
@@ -0,0 +1,138 @@
+#include "ChunkPregenerator.h"
+
+#include <algorithm>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Not idle priority: this thread takes locks (malloc, the noise column cache) that the search threads need,
+// and an idle priority lock holder could keep them waiting for as long as the cpus are busy.
+static void lowerCurrentThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    // linux threads have their own nice value
+    setpriority(PRIO_PROCESS, gettid(), 10);
+#endif
+}
+
+ChunkPregenerator::~ChunkPregenerator() {
+    stop();
+}
+
+void ChunkPregenerator::setEnabled(bool enabled) {
+    if (!enabled) {
+        stop();
+    } else if (!thread.joinable()) {
+        stopRequest = false;
+        thread = std::thread([this] { run(); });
+    }
+}
+
+void ChunkPregenerator::stop() {
+    {
+        std::lock_guard lock(mutex);
+        stopRequest = true;
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    jobs.clear();
+    results.clear();
+    pending.clear();
+}
+
+void ChunkPregenerator::run() {
+    lowerCurrentThreadPriority();
+    // The pool threads run at normal priority and are shared with the searches, so the background tiles stay on this thread
+    ChunkGenExec executor{false};
+
+    std::unique_lock lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return stopRequest || !jobs.empty(); });
+        if (stopRequest) return;
+
+        const Job job = jobs.front();
+        jobs.pop_front();
+        lock.unlock();
+
+        std::vector<Result> done;
+        std::array<Chunk*, GEN_TILE_SIZE * GEN_TILE_SIZE> chunks{};
+        for (int i = 0; i < GEN_TILE_SIZE * GEN_TILE_SIZE; i++) {
+            if (!(job.missing & (1u << i))) continue;
+            done.push_back({ChunkPos{job.tile.x + i / GEN_TILE_SIZE, job.tile.z + i % GEN_TILE_SIZE}, std::make_unique<Chunk>()});
+            chunks[i] = done.back().chunk.get();
+        }
+        this->generator.generateTile(job.tile.x, job.tile.z, GEN_TILE_SIZE, chunks.data(), executor);
+        generated.fetch_add(done.size(), std::memory_order_relaxed);
+
+        lock.lock();
+        std::move(done.begin(), done.end(), std::back_inserter(results));
+    }
+}
+
+void ChunkPregenerator::request(const cache_t& cache, const ChunkPos& tile, bool urgent) {
+    uint32_t missing = 0;
+    for (int i = 0; i < GEN_TILE_SIZE; i++) {
+        for (int j = 0; j < GEN_TILE_SIZE; j++) {
+            if (!cache.contains(ChunkPos{tile.x + i, tile.z + j})) {
+                missing |= 1u << (i * GEN_TILE_SIZE + j);
+            }
+        }
+    }
+    if (missing == 0) return;
+
+    {
+        std::lock_guard lock(mutex);
+        if (pending.contains(tile)) return;
+        if (jobs.size() >= MAX_QUEUED) {
+            if (!urgent) return;
+            pending.erase(jobs.back().tile);
+            jobs.pop_back();
+        }
+        pending.emplace(tile, true);
+        if (urgent) {
+            jobs.push_front({tile, missing});
+        } else {
+            jobs.push_back({tile, missing});
+        }
+    }
+    condition.notify_one();
+}
+
+void ChunkPregenerator::drain(cache_t& cache, Allocator<Chunk>& allocator, ChunkCompressor& compressor) {
+    std::vector<Result> done;
+    {
+        std::lock_guard lock(mutex);
+        if (results.empty()) return;
+        done.swap(results);
+        for (const Result& result : done) {
+            pending.erase(tileOf(result.pos));
+        }
+    }
+    for (Result& result : done) {
+        if (cache.contains(result.pos)) continue;
+        Chunk* chunk = allocator.allocate();
+        for (size_t i = 0; i < chunk->data.size(); i++) {
+            // allocated chunks are zeroed and writing zeros would commit pages that the page allocator hasn't touched yet
+            if (!isEmpty(result.chunk->data[i])) chunk->data[i] = result.chunk->data[i];
+        }
+        cache.emplace(result.pos, std::pair{ChunkState::FAKE, chunk});
+        compressor.touch(result.pos);
+        used.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ChunkPregenerator::cancel() {
+    std::lock_guard lock(mutex);
+    for (const Job& job : jobs) {
+        pending.erase(job.tile);
+    }
+    jobs.clear();
+}
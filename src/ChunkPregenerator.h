@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <span>
+
+#include "Chunk.h"
+#include "ChunkGen.h"
+#include "ChunkGeneratorHell.h"
+#include "Allocator.h"
+#include "ChunkCompressor.h"
+
+// Speculatively generates the tiles the search is expected to need on a low priority background thread.
+// Finished chunks are kept here until the search thread moves them into the cache with drain,
+// so the background thread never touches the cache or the chunk allocator.
+struct ChunkPregenerator {
+    // at most this many tiles are queued, requests beyond that replace the oldest non urgent ones
+    static constexpr size_t MAX_QUEUED = 64;
+
+    std::atomic_uint64_t generated{}; // chunks generated in the background
+    std::atomic_uint64_t used{}; // generated chunks that were moved into the cache (the rest were already there)
+
+    explicit ChunkPregenerator(const ChunkGeneratorHell& generator): generator(generator) {}
+    ChunkPregenerator(const ChunkPregenerator&) = delete;
+    ~ChunkPregenerator();
+
+    void setEnabled(bool enabled);
+    bool enabled() const {
+        return thread.joinable();
+    }
+
+    // Queues the chunks of a tile that aren't in the cache, urgent tiles are generated before everything else.
+    // Must be called by the thread that owns the cache.
+    void request(const cache_t& cache, const ChunkPos& tile, bool urgent);
+    // Moves finished chunks that aren't in the cache yet into it.
+    // Must be called by the thread that owns the cache while nothing is generating chunks into it.
+    void drain(cache_t& cache, Allocator<Chunk>& allocator, ChunkCompressor& compressor);
+    // Drops every queued tile, the tile being generated is still finished
+    void cancel();
+    void stop();
+
+private:
+    struct Job {
+        ChunkPos tile;
+        uint32_t missing; // bit i * GEN_TILE_SIZE + j is chunk (tile.x + i, tile.z + j)
+    };
+    struct Result {
+        ChunkPos pos;
+        std::unique_ptr<Chunk> chunk;
+    };
+
+    const ChunkGeneratorHell& generator;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Job> jobs;
+    map_t<ChunkPos, bool> pending; // tiles that are queued, being generated or have unclaimed results
+    std::vector<Result> results;
+    bool stopRequest = false;
+    std::thread thread;
+
+    void run();
+};
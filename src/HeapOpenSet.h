@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+#include "PathNode.h"
+#include "PathNodeArena.h"
+
+// A d-ary min heap of the open nodes that keeps their combinedCost next to their index, so finding the place of a node
+// only reads the heap and the nodes are only touched to write their new heapPosition.
+// HeapOpenSet<2> orders the nodes exactly like BinaryHeapOpenSet, with 4 the children of a node share a cache line.
+template<int Arity>
+struct HeapOpenSet {
+private:
+    static_assert(Arity >= 2);
+    static constexpr int INITIAL_CAPACITY = 1024;
+
+    struct Entry {
+        float cost;
+        uint32_t index;
+    };
+
+    PathNodeArena& nodes;
+    std::vector<Entry> heap;
+
+    void place(int position, const Entry& entry) {
+        this->heap[position] = entry;
+        this->nodes[entry.index].heapPosition = position;
+    }
+
+    void siftUp(int position, const Entry& entry) {
+        while (position > 0) {
+            const int parent = (position - 1) / Arity;
+            if (this->heap[parent].cost <= entry.cost) break;
+            place(position, this->heap[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void siftDown(int position, const Entry& entry) {
+        const int size = (int) this->heap.size();
+        while (true) {
+            const int first = position * Arity + 1;
+            if (first >= size) break;
+            const int last = std::min(first + Arity, size);
+            int smallest = first;
+            for (int child = first + 1; child < last; child++) {
+                if (this->heap[child].cost < this->heap[smallest].cost) smallest = child;
+            }
+            if (entry.cost <= this->heap[smallest].cost) break;
+            place(position, this->heap[smallest]);
+            position = smallest;
+        }
+        place(position, entry);
+    }
+
+public:
+    explicit HeapOpenSet(PathNodeArena& nodes): nodes(nodes) {
+        this->heap.reserve(INITIAL_CAPACITY);
+    }
+
+    [[nodiscard]] int getSize() const {
+        return (int) this->heap.size();
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return this->heap.empty();
+    }
+
+    void insert(PathNode* value) {
+        assert(value != nullptr);
+        this->heap.emplace_back();
+        siftUp((int) this->heap.size() - 1, {value->combinedCost, value->index});
+    }
+
+    // the cost of val can only have gone down
+    void update(PathNode* val) {
+        siftUp(val->heapPosition, {val->combinedCost, val->index});
+    }
+
+    PathNode* removeLowest() {
+        if (this->heap.empty()) throw "trolled";
+
+        PathNode* result = &this->nodes[this->heap[0].index];
+        result->heapPosition = -1;
+        const Entry last = this->heap.back();
+        this->heap.pop_back();
+        if (!this->heap.empty()) {
+            siftDown(0, last);
+        }
+        return result;
+    }
+};
@@ -0,0 +1,311 @@
+#include "IncrementalSearch.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+}
+
+void IncrementalSearch::reset() {
+    this->goal.reset();
+    this->nodes.clear();
+    this->nodeIndex.clear();
+    this->nodesByChunk.clear();
+    this->queue = {};
+    this->keyModifier = 0;
+    this->startSteps.clear();
+    this->changedChunks.clear();
+}
+
+void IncrementalSearch::chunkChanged(const ChunkPos& pos) {
+    if (this->goal) this->changedChunks.insert(pos);
+}
+
+void IncrementalSearch::chunksChanged(const ChunkPos& min, const ChunkPos& max) {
+    if (!this->goal) return;
+    for (int x = min.x; x <= max.x; x++) {
+        for (int z = min.z; z <= max.z; z++) {
+            this->changedChunks.insert({x, z});
+        }
+    }
+}
+
+uint32_t IncrementalSearch::getOrCreate(const NodePos& pos, float stepCost) {
+    auto [it, inserted] = this->nodeIndex.try_emplace(pos, (uint32_t) this->nodes.size());
+    if (inserted) {
+        this->nodes.push_back(Node{.pos = pos, .g = INF, .rhs = INF, .stepCost = stepCost});
+        this->nodesByChunk[pos.absolutePosZero().toChunkPos()].push_back(it->second);
+    } else if (Node& node = this->nodes[it->second]; node.blocked) {
+        // the world says it's air
+        node.blocked = false;
+        node.stepCost = stepCost;
+    }
+    return it->second;
+}
+
+std::pair<double, double> IncrementalSearch::key(const Node& node, const BlockPos& start) const {
+    const double best = std::min(node.g, node.rhs);
+    return {best + PathNode::heuristic(node.pos, start) + this->keyModifier, best};
+}
+
+void IncrementalSearch::updateQueue(uint32_t index, const BlockPos& start) {
+    Node& node = this->nodes[index];
+    if (node.g == node.rhs) {
+        node.queued = false;
+        return;
+    }
+    const auto [key1, key2] = key(node, start);
+    if (!node.queued || node.key1 != key1 || node.key2 != key2) {
+        node.queued = true;
+        node.key1 = key1;
+        node.key2 = key2;
+        this->queue.push({key1, key2, index});
+    }
+}
+
+void IncrementalSearch::computeRhs(uint32_t index) {
+    Node& node = this->nodes[index];
+    if (index == this->goalNode) {
+        node.rhs = node.blocked ? INF : 0;
+        return;
+    }
+    double rhs = INF;
+    if (!node.blocked) {
+        for (const uint32_t successor : node.successors) {
+            rhs = std::min(rhs, this->nodes[successor].stepCost + this->nodes[successor].g);
+        }
+        if (index == this->startNode) {
+            for (const uint32_t successor : this->startSteps) {
+                rhs = std::min(rhs, this->nodes[successor].stepCost + this->nodes[successor].g);
+            }
+        }
+    }
+    node.rhs = rhs;
+}
+
+bool IncrementalSearch::findNeighbors(const NodePos& pos, World& world, std::vector<uint32_t>& out) {
+    this->neighborScratch.clear();
+    if (!world.neighbors(pos, this->neighborScratch)) return false;
+    out.clear();
+    for (const auto& [neighbor, stepCost] : this->neighborScratch) {
+        out.push_back(getOrCreate(neighbor, stepCost));
+    }
+    // a cube can be the neighbor on two faces if it grew
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
+void IncrementalSearch::setNeighbors(uint32_t index, std::vector<uint32_t>&& neighbors, std::vector<uint32_t>& changed) {
+    const std::vector<uint32_t>& old = this->nodes[index].neighbors;
+    for (const uint32_t neighbor : old) {
+        if (std::find(neighbors.begin(), neighbors.end(), neighbor) == neighbors.end()) {
+            std::erase(this->nodes[neighbor].successors, index);
+            changed.push_back(neighbor);
+        }
+    }
+    for (const uint32_t neighbor : neighbors) {
+        if (std::find(old.begin(), old.end(), neighbor) == old.end()) {
+            this->nodes[neighbor].successors.push_back(index);
+            changed.push_back(neighbor);
+        }
+    }
+    this->nodes[index].neighbors = std::move(neighbors);
+}
+
+bool IncrementalSearch::repair(World& world, const BlockPos& start) {
+    if (this->changedChunks.empty()) return true;
+    // the steps into a cube of a chunk come from that chunk or the ones next to it
+    std::vector<uint32_t> affected;
+    for (const ChunkPos& pos : this->changedChunks) {
+        for (const ChunkPos& chunk : {pos, ChunkPos{pos.x + 1, pos.z}, ChunkPos{pos.x - 1, pos.z}, ChunkPos{pos.x, pos.z + 1}, ChunkPos{pos.x, pos.z - 1}}) {
+            if (auto it = this->nodesByChunk.find(chunk); it != this->nodesByChunk.end()) {
+                affected.insert(affected.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    std::vector<uint32_t> changed;
+    std::vector<uint32_t> neighbors;
+    for (const uint32_t index : affected) {
+        const std::optional<float> stepCost = world.stepCost(this->nodes[index].pos);
+        if (!stepCost) {
+            if (this->nodes[index].blocked) continue;
+            this->nodes[index].blocked = true;
+            this->nodes[index].expanded = false;
+            setNeighbors(index, {}, changed);
+            for (const uint32_t successor : this->nodes[index].successors) {
+                std::erase(this->nodes[successor].neighbors, index);
+            }
+            this->nodes[index].successors.clear();
+            changed.push_back(index);
+            continue;
+        }
+        if (this->nodes[index].blocked) {
+            this->nodes[index].blocked = false;
+            changed.push_back(index);
+        }
+        if (*stepCost != this->nodes[index].stepCost) {
+            this->nodes[index].stepCost = *stepCost;
+            const auto& predecessors = this->nodes[index].neighbors;
+            changed.insert(changed.end(), predecessors.begin(), predecessors.end());
+        }
+        if (this->nodes[index].expanded) {
+            if (!findNeighbors(this->nodes[index].pos, world, neighbors)) return false;
+            setNeighbors(index, std::move(neighbors), changed);
+            neighbors = {};
+        }
+    }
+    for (const uint32_t index : changed) {
+        computeRhs(index);
+        updateQueue(index, start);
+    }
+    // only now, the nodes checked so far would just be checked again if the world gave up
+    this->changedChunks.clear();
+    return true;
+}
+
+IncrementalSearch::Result IncrementalSearch::plan(const NodePos& start, const NodePos& goal, const Settings& settings, World& world, std::vector<std::pair<NodePos, double>>& path) {
+    const BlockPos startCenter = start.absolutePosCenter();
+    if (this->goal != goal || this->settings != settings) {
+        reset();
+        const std::optional<float> stepCost = world.stepCost(goal);
+        if (!stepCost) return Result::NO_PATH;
+        this->goal = goal;
+        this->settings = settings;
+        this->goalNode = getOrCreate(goal, *stepCost);
+        this->startNode = this->goalNode;
+        this->nodes[this->goalNode].rhs = 0;
+        this->lastStart = startCenter;
+        updateQueue(this->goalNode, startCenter);
+    }
+    // the keys that are queued are at most this much too high now (see D* Lite)
+    this->keyModifier += this->lastStart.distanceTo(startCenter);
+    this->lastStart = startCenter;
+    if (!repair(world, startCenter)) return Result::GAVE_UP;
+
+    const std::optional<float> startCost = world.stepCost(start);
+    if (!startCost) return Result::NO_PATH;
+    const uint32_t oldStart = this->startNode;
+    this->startNode = getOrCreate(start, *startCost);
+    if (!findNeighbors(start, world, this->startSteps)) return Result::GAVE_UP;
+    for (const uint32_t index : {oldStart, this->startNode}) {
+        computeRhs(index);
+        updateQueue(index, startCenter);
+    }
+
+    // The heuristic isn't consistent so a node on the way can still be queued when the loop stops, it's made
+    // consistent and the loop goes on until the path doesn't go through one anymore.
+    for (;;) {
+        if (!computePath(world, startCenter)) return Result::GAVE_UP;
+        const Node& startNode = this->nodes[this->startNode];
+        if (std::min(startNode.g, startNode.rhs) == INF) return Result::NO_PATH;
+        path.clear();
+        uint32_t current = this->startNode;
+        std::optional<uint32_t> inconsistent;
+        while (!inconsistent) {
+            const Node& node = this->nodes[current];
+            if (current != this->startNode && node.g != node.rhs) {
+                inconsistent = current;
+                break;
+            }
+            path.emplace_back(node.pos, current == this->startNode ? std::min(node.g, node.rhs) : node.g);
+            if (current == this->goalNode) return Result::FOUND;
+            uint32_t best = current;
+            double bestCost = INF;
+            auto consider = [&](uint32_t successor) {
+                const double cost = this->nodes[successor].stepCost + this->nodes[successor].g;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    best = successor;
+                }
+            };
+            for (const uint32_t successor : node.successors) consider(successor);
+            if (current == this->startNode) {
+                for (const uint32_t successor : this->startSteps) consider(successor);
+            }
+            // a consistent node always has a cheaper successor, the start gets one from the loop
+            if (best == current) {
+                inconsistent = current;
+            }
+            current = best;
+        }
+        if (!process(*inconsistent, world, startCenter)) return Result::GAVE_UP;
+    }
+}
+
+bool IncrementalSearch::process(uint32_t index, World& world, const BlockPos& start) {
+    if (this->nodes[index].g > this->nodes[index].rhs) {
+        // the nodes that step into it are needed before it's done, it stays queued if that gives up
+        if (!this->nodes[index].expanded) {
+            std::vector<uint32_t> neighbors;
+            if (!findNeighbors(this->nodes[index].pos, world, neighbors)) return false;
+            std::vector<uint32_t> changed;
+            setNeighbors(index, std::move(neighbors), changed);
+            this->nodes[index].expanded = true;
+        }
+        this->nodes[index].queued = false;
+        this->expansions++;
+        Node& node = this->nodes[index];
+        node.g = node.rhs;
+        const double through = node.stepCost + node.g;
+        for (const uint32_t neighbor : node.neighbors) {
+            Node& predecessor = this->nodes[neighbor];
+            if (neighbor != this->goalNode && !predecessor.blocked && through < predecessor.rhs) {
+                predecessor.rhs = through;
+                updateQueue(neighbor, start);
+            }
+        }
+    } else {
+        this->nodes[index].queued = false;
+        this->expansions++;
+        const double oldThrough = this->nodes[index].stepCost + this->nodes[index].g;
+        this->nodes[index].g = INF;
+        computeRhs(index);
+        updateQueue(index, start);
+        for (const uint32_t neighbor : this->nodes[index].neighbors) {
+            if (this->nodes[neighbor].rhs == oldThrough) {
+                computeRhs(neighbor);
+                updateQueue(neighbor, start);
+            }
+        }
+    }
+    if (std::find(this->startSteps.begin(), this->startSteps.end(), index) != this->startSteps.end()) {
+        computeRhs(this->startNode);
+        updateQueue(this->startNode, start);
+    }
+    return true;
+}
+
+bool IncrementalSearch::computePath(World& world, const BlockPos& start) {
+    for (int iterations = 0; !this->queue.empty(); iterations++) {
+        const Queued top = this->queue.top();
+        if (const Node& node = this->nodes[top.node]; !node.queued || node.key1 != top.key1 || node.key2 != top.key2) {
+            this->queue.pop();
+            continue;
+        }
+        const Node& startNode = this->nodes[this->startNode];
+        if (!(std::pair{top.key1, top.key2} < key(startNode, start)) && startNode.rhs <= startNode.g) break;
+        constexpr int timeCheckInterval = 1 << 6;
+        if ((iterations & (timeCheckInterval - 1)) == 0 && world.expired()) return false;
+
+        if (const auto newKey = key(this->nodes[top.node], start); std::pair{top.key1, top.key2} < newKey) {
+            // queued before the start moved
+            this->queue.pop();
+            this->nodes[top.node].key1 = newKey.first;
+            this->nodes[top.node].key2 = newKey.second;
+            this->queue.push({newKey.first, newKey.second, top.node});
+            continue;
+        }
+        // processing it can queue it again
+        this->queue.pop();
+        if (!process(top.node, world, start)) {
+            this->queue.push(top);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+#include "Utils.h"
+#include "PathNode.h"
+
+// D* Lite over the nodes of the octree search. It searches from the goal to the start and keeps its nodes between
+// calls, so when the start moves or chunks change only the part of the search that they affect is done again. Near
+// the player that is usually a few nodes at the end of the search.
+// g is the cost of a node's path to the goal and rhs the cost through its best successor, the nodes whose g and rhs
+// differ are queued. A step into a node costs the same from every side. The nodes that can step into a node are the
+// neighbors the normal search finds for it (two air cubes that share a face can be walked between both ways), and the
+// start can also step into its own neighbors since the search from the goal rarely finds a cube of its size there.
+// The keys use the heuristic of the normal search towards the start, which isn't consistent, so like it the paths are
+// good rather than the cheapest.
+// Like the chunk cache it must only be used by the thread that owns the context.
+struct IncrementalSearch {
+    // How the search sees the world, see findPathIncremental
+    struct World {
+        virtual ~World() = default;
+        // the cost of a step into pos, nothing if it isn't air
+        virtual std::optional<float> stepCost(const NodePos& pos) = 0;
+        // the neighbors of pos (which is air) and the cost of a step into them, returns false if the search should give up
+        virtual bool neighbors(const NodePos& pos, std::vector<std::pair<NodePos, float>>& out) = 0;
+        // checked every few expansions, the search gives up if it returns true
+        virtual bool expired() = 0;
+    };
+
+    // the searches with other settings don't share any nodes
+    struct Settings {
+        bool x4Min;
+        bool airIfFake;
+        double fakeChunkCost;
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    enum class Result {
+        FOUND,
+        NO_PATH,
+        GAVE_UP // the world gave up or expired, plan can go on from there the next time
+    };
+
+    IncrementalSearch() = default;
+    IncrementalSearch(const IncrementalSearch&) = delete;
+
+    // Plans from start to goal. The nodes (and what is queued) are kept if the last plan went to the same goal with the
+    // same settings. path gets the nodes from start to goal with the cost of their path to the goal.
+    Result plan(const NodePos& start, const NodePos& goal, const Settings& settings, World& world, std::vector<std::pair<NodePos, double>>& path);
+
+    // the nodes in or next to the chunk are checked again at the next plan
+    void chunkChanged(const ChunkPos& pos);
+    // chunkChanged for every chunk in the rectangle
+    void chunksChanged(const ChunkPos& min, const ChunkPos& max);
+    void reset();
+
+    [[nodiscard]] size_t nodeCount() const {
+        return this->nodes.size();
+    }
+    // how many nodes were made consistent, including the ones of the searches that were reset since
+    [[nodiscard]] uint64_t getExpansions() const {
+        return this->expansions;
+    }
+
+private:
+    struct Node {
+        NodePos pos;
+        double g;
+        double rhs;
+        // what it is queued with if queued is set
+        double key1 = 0;
+        double key2 = 0;
+        float stepCost;
+        bool queued = false;
+        // neighbors is what World::neighbors returned for it
+        bool expanded = false;
+        // it turned solid, nothing steps into it until it's air again
+        bool blocked = false;
+        // the nodes that step into this one and the ones this one steps into
+        std::vector<uint32_t> neighbors;
+        std::vector<uint32_t> successors;
+    };
+    struct Queued {
+        double key1, key2;
+        uint32_t node;
+
+        bool operator<(const Queued& other) const {
+            return this->key1 != other.key1 ? this->key1 > other.key1 : this->key2 > other.key2;
+        }
+    };
+
+    std::optional<NodePos> goal;
+    Settings settings{};
+    std::vector<Node> nodes;
+    std::unordered_map<NodePos, uint32_t> nodeIndex;
+    std::unordered_map<ChunkPos, std::vector<uint32_t>> nodesByChunk;
+    // stale entries (the node isn't queued anymore or has another key) are skipped
+    std::priority_queue<Queued> queue;
+    // what the keys in the queue are behind by since the start moved
+    double keyModifier = 0;
+    BlockPos lastStart{};
+    uint32_t goalNode = 0;
+    uint32_t startNode = 0;
+    // the nodes the start steps into, which aren't in their neighbors
+    std::vector<uint32_t> startSteps;
+    std::unordered_set<ChunkPos> changedChunks;
+    uint64_t expansions = 0;
+    std::vector<std::pair<NodePos, float>> neighborScratch;
+
+    uint32_t getOrCreate(const NodePos& pos, float stepCost);
+    [[nodiscard]] std::pair<double, double> key(const Node& node, const BlockPos& start) const;
+    void updateQueue(uint32_t node, const BlockPos& start);
+    // rhs from the successors
+    void computeRhs(uint32_t node);
+    // the nodes from World::neighbors, false if the world gave up
+    bool findNeighbors(const NodePos& pos, World& world, std::vector<uint32_t>& out);
+    // replaces the nodes that step into node, the ones whose successors changed are added to changed
+    void setNeighbors(uint32_t node, std::vector<uint32_t>&& neighbors, std::vector<uint32_t>& changed);
+    // checks the nodes around changedChunks, false if the world gave up
+    bool repair(World& world, const BlockPos& start);
+    // makes an inconsistent node consistent (or underconsistent ones overconsistent), false if the world gave up
+    bool process(uint32_t node, World& world, const BlockPos& start);
+    // processes the queue until the start is done, false if the world gave up or expired
+    bool computePath(World& world, const BlockPos& start);
+};
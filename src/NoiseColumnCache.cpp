@@ -0,0 +1,54 @@
+#include "NoiseColumnCache.h"
+
+#include <algorithm>
+
+void NoiseColumnCache::setCapacity(size_t columns) {
+    capacity.store(columns, std::memory_order_relaxed);
+    const size_t perShard = columns / SHARDS;
+    for (Shard& shard : shards) {
+        std::lock_guard lock(shard.mutex);
+        if (columns == 0) {
+            shard.columns = {};
+            shard.order = {};
+            continue;
+        }
+        while (shard.order.size() > perShard) {
+            shard.columns.erase(shard.order.front());
+            shard.order.pop_front();
+        }
+    }
+}
+
+bool NoiseColumnCache::get(int x, int z, double* out) {
+    const uint64_t k = key(x, z);
+    Shard& shard = shardFor(k);
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.columns.find(k);
+    if (it == shard.columns.end()) return false;
+    std::copy(it->second.begin(), it->second.end(), out);
+    return true;
+}
+
+void NoiseColumnCache::put(int x, int z, const double* column) {
+    const size_t perShard = std::max<size_t>(capacity.load(std::memory_order_relaxed) / SHARDS, 1);
+    const uint64_t k = key(x, z);
+    Shard& shard = shardFor(k);
+    std::lock_guard lock(shard.mutex);
+    auto [it, inserted] = shard.columns.try_emplace(k);
+    if (!inserted) return;
+    std::copy(column, column + Y_SIZE, it->second.begin());
+    shard.order.push_back(k);
+    while (shard.order.size() > perShard) {
+        shard.columns.erase(shard.order.front());
+        shard.order.pop_front();
+    }
+}
+
+size_t NoiseColumnCache::size() {
+    size_t total = 0;
+    for (Shard& shard : shards) {
+        std::lock_guard lock(shard.mutex);
+        total += shard.columns.size();
+    }
+    return total;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "ChunkGen.h"
+
+// Bounded cache of the final density (getHeights output) of noise lattice columns, keyed by lattice x and z.
+// Neighbouring chunks share the lattice columns on their edges, so a chunk generated next to cached ones
+// only has to compute the rest.
+// It is split into shards that each have their own lock so the generators of every executor can share it,
+// and the oldest columns in a shard are dropped first when it is full.
+struct NoiseColumnCache {
+    static constexpr int Y_SIZE = 17;
+    using Column = std::array<double, Y_SIZE>;
+
+    std::atomic_uint64_t hits{};
+    std::atomic_uint64_t misses{};
+    // total time spent generating chunks while the cache was enabled, to compare with it disabled
+    std::atomic_uint64_t generatedChunks{};
+    std::atomic_uint64_t generateNanos{};
+
+    // 0 disables the cache and frees every column
+    void setCapacity(size_t columns);
+    bool enabled() const {
+        return capacity.load(std::memory_order_relaxed) != 0;
+    }
+
+    bool get(int x, int z, double* out);
+    void put(int x, int z, const double* column);
+
+    size_t size();
+
+private:
+    static constexpr int SHARDS = 16;
+
+    struct Shard {
+        std::mutex mutex;
+        map_t<uint64_t, Column> columns;
+        std::deque<uint64_t> order; // insertion order
+    };
+
+    std::atomic_size_t capacity{};
+    std::array<Shard, SHARDS> shards;
+
+    static uint64_t key(int x, int z) {
+        return (uint64_t) (uint32_t) x << 32 | (uint32_t) z;
+    }
+    Shard& shardFor(uint64_t key) {
+        // lattice columns next to each other should be spread across the shards
+        return shards[(key ^ (key >> 32)) % SHARDS];
+    }
+};
@@ -1,18 +1,27 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <cstdio>
 
 #include "Random.h"
 
+#if defined(__x86_64__)
+#define NOISE_SIMD 1
+#else
+#define NOISE_SIMD 0
+#endif
 
 // This only effects the random number generator in the constructor
+// A generator is kept as small as possible (280 bytes) because a ChunkGeneratorHell has 40 of them and they're all
+// read for every chunk, so they should all fit in L1 together.
 struct NoiseGeneratorImproved {
-    std::array<short, 512> permutations{};
     // must be declared in this order
     const double xCoord;
     const double yCoord;
     const double zCoord;
+    // The java table has 512 entries where the second half repeats the first, every index is masked with & 255 instead.
+    std::array<uint8_t, 256> permutations{};
 
     explicit NoiseGeneratorImproved(Random& random):
         xCoord(random.nextDouble() * 256.0),  yCoord(random.nextDouble() * 256.0), zCoord(random.nextDouble() * 256.0)
@@ -27,10 +36,37 @@ struct NoiseGeneratorImproved {
                 int k = permutations[l];
                 permutations[l] = permutations[j];
                 permutations[j] = k;
-                permutations[l + 256] = permutations[l];
             }
         }
 
 
-    void populateNoiseArray(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale) const;
+    // uses the best implementation supported by the cpu, they all produce the exact same output.
+    // xStart, yStart and zStart skip the first lattice points, so the output is exactly the same as that part of a bigger array.
+    void populateNoiseArray(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const;
+
+    void populateNoiseArrayScalar(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const;
+#if NOISE_SIMD
+    // 4 y values at a time
+    void populateNoiseArrayAvx2(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const;
+    void populateNoiseArraySse2(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const;
+#endif
+
+private:
+    // the java table index, which can be up to 511
+    int perm(int i) const {
+        return permutations[i & 255];
+    }
+
+    // The gradients are only recomputed when the y cell changes, using the fractional y of the first y value in that cell.
+    // This is that fractional y for y value yStart, which may be in the same cell as the ones before it.
+    double firstGradientY(double yOffset, double yScale, int yStart) const;
+};
+
+// The gradient of hash & 15 as {x, y, z, 0}, one 32 byte row each so a gradient is a single aligned load.
+// The java GRAD_2X and GRAD_2Z tables are the same as the x and z columns.
+alignas(32) static constexpr double GRAD[16][4] = {
+    {1.0, 1.0, 0.0, 0.0}, {-1.0, 1.0, 0.0, 0.0}, {1.0, -1.0, 0.0, 0.0}, {-1.0, -1.0, 0.0, 0.0},
+    {1.0, 0.0, 1.0, 0.0}, {-1.0, 0.0, 1.0, 0.0}, {1.0, 0.0, -1.0, 0.0}, {-1.0, 0.0, -1.0, 0.0},
+    {0.0, 1.0, 1.0, 0.0}, {0.0, -1.0, 1.0, 0.0}, {0.0, 1.0, -1.0, 0.0}, {0.0, -1.0, -1.0, 0.0},
+    {1.0, 1.0, 0.0, 0.0}, {0.0, -1.0, 1.0, 0.0}, {-1.0, 1.0, 0.0, 0.0}, {0.0, -1.0, -1.0, 0.0},
 };
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "NoiseGeneratorImproved.h"
+
+#if NOISE_SIMD
+#include <cstdlib>
+#include <immintrin.h>
+
+// These have to produce the exact same bits as populateNoiseArrayScalar (which matches the java code) so
+// every operation is done in the same order and fma is never used.
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+// the shared helpers have to be inlined into the avx2 code or every call would switch between sse and avx instructions
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace {
+    constexpr int MAX_Y = 32;
+
+    // Everything that only depends on y, which is shared by every column.
+    // The scalar code only recomputes the gradients when the y cell changes, so every y in a cell uses
+    // the fractional y of the first one (gradY) for the gradients and its own for the fade.
+    struct YLattice {
+        alignas(32) int cell[MAX_Y];
+        alignas(32) double gradY[MAX_Y];
+        alignas(32) double fade[MAX_Y];
+    };
+
+    // gradY0 is the fractional y the gradients of the first y value use (see firstGradientY)
+    ALWAYS_INLINE YLattice computeY(double yOffset, int yStart, int ySize, double yScale, double yCoord, double gradY0) {
+        YLattice out{};
+        for (int j4 = 0; j4 < ySize; ++j4) {
+            double d9 = yOffset + (double)(yStart + j4) * yScale + yCoord;
+            int k4 = (int)d9;
+
+            if (d9 < (double)k4) {
+                --k4;
+            }
+
+            const int l4 = k4 & 255;
+            d9 = d9 - (double)k4;
+            out.cell[j4] = l4;
+            out.gradY[j4] = j4 == 0 ? gradY0 : l4 != out.cell[j4 - 1] ? d9 : out.gradY[j4 - 1];
+            out.fade[j4] = d9 * d9 * d9 * (d9 * (d9 * 6.0 - 15.0) + 10.0);
+        }
+        return out;
+    }
+
+    // the integer cell (& 255), fractional part and fade of a coordinate
+    struct Axis {
+        int cell;
+        double frac;
+        double fade;
+    };
+
+    ALWAYS_INLINE Axis computeAxis(double d) {
+        int i = (int)d;
+
+        if (d < (double)i) {
+            --i;
+        }
+
+        d = d - (double)i;
+        return {i & 255, d, d * d * d * (d * (d * 6.0 - 15.0) + 10.0)};
+    }
+
+    // The 8 gradient hashes of 4 y values in the same column.
+    // This is scalar because avx2 gathers were measured to be slower than plain loads for this (and for the GRAD table).
+    // perm is the 256 entry table, indices are masked because the java table is twice as big with the second half repeated.
+    ALWAYS_INLINE void hashLanes(const uint8_t* perm, int a, int b, int i4, const int* cells, int (&hash)[8][4]) {
+        const auto p = [perm](int i) -> int { return perm[i & 255]; };
+        for (int r = 0; r < 4; r++) {
+            const int l = a + cells[r];
+            const int k1 = b + cells[r];
+            const int i1 = p(l) + i4;
+            const int j1 = p(l + 1) + i4;
+            const int l1 = p(k1) + i4;
+            const int i2 = p(k1 + 1) + i4;
+            hash[0][r] = p(i1);
+            hash[1][r] = p(l1);
+            hash[2][r] = p(j1);
+            hash[3][r] = p(i2);
+            hash[4][r] = p(i1 + 1);
+            hash[5][r] = p(l1 + 1);
+            hash[6][r] = p(j1 + 1);
+            hash[7][r] = p(i2 + 1);
+        }
+    }
+
+    // the GRAD rows of 4 hashes transposed into x, y and z vectors
+    TARGET_AVX2 inline __m256d grad4(const int* hash, __m256d x, __m256d y, __m256d z) {
+        const __m256d r0 = _mm256_load_pd(GRAD[hash[0] & 15]);
+        const __m256d r1 = _mm256_load_pd(GRAD[hash[1] & 15]);
+        const __m256d r2 = _mm256_load_pd(GRAD[hash[2] & 15]);
+        const __m256d r3 = _mm256_load_pd(GRAD[hash[3] & 15]);
+        const __m256d xz01 = _mm256_unpacklo_pd(r0, r1);
+        const __m256d xz23 = _mm256_unpacklo_pd(r2, r3);
+        const __m256d y01 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d y23 = _mm256_unpackhi_pd(r2, r3);
+        const __m256d gx = _mm256_permute2f128_pd(xz01, xz23, 0x20);
+        const __m256d gy = _mm256_permute2f128_pd(y01, y23, 0x20);
+        const __m256d gz = _mm256_permute2f128_pd(xz01, xz23, 0x31);
+        return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(gx, x), _mm256_mul_pd(gy, y)), _mm256_mul_pd(gz, z));
+    }
+
+    TARGET_AVX2 inline __m256d lerp4(__m256d a, __m256d b, __m256d c) {
+        return _mm256_add_pd(b, _mm256_mul_pd(a, _mm256_sub_pd(c, b)));
+    }
+
+    inline __m128d grad2(const int* hash, __m128d x, __m128d y, __m128d z) {
+        const double* g0 = GRAD[hash[0] & 15];
+        const double* g1 = GRAD[hash[1] & 15];
+        const __m128d xy0 = _mm_load_pd(g0), xy1 = _mm_load_pd(g1);
+        const __m128d gx = _mm_unpacklo_pd(xy0, xy1);
+        const __m128d gy = _mm_unpackhi_pd(xy0, xy1);
+        const __m128d gz = _mm_unpacklo_pd(_mm_load_pd(g0 + 2), _mm_load_pd(g1 + 2));
+        return _mm_add_pd(_mm_add_pd(_mm_mul_pd(gx, x), _mm_mul_pd(gy, y)), _mm_mul_pd(gz, z));
+    }
+
+    inline __m128d lerp2(__m128d a, __m128d b, __m128d c) {
+        return _mm_add_pd(b, _mm_mul_pd(a, _mm_sub_pd(c, b)));
+    }
+}
+
+TARGET_AVX2
+void NoiseGeneratorImproved::populateNoiseArrayAvx2(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const {
+    if (ySize == 1) exit(1); // uses different code that's deleted
+    if (ySize > MAX_Y) {
+        populateNoiseArrayScalar(noiseArray, xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale, noiseScale, xStart, yStart, zStart);
+        return;
+    }
+    const uint8_t* perm = this->permutations.data();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d d0 = _mm256_set1_pd(1.0 / noiseScale);
+    const YLattice yl = computeY(yOffset, yStart, ySize, yScale, this->yCoord, firstGradientY(yOffset, yScale, yStart));
+    int i = 0;
+
+    for (int l2 = xStart; l2 < xStart + xSize; ++l2) {
+        const Axis ax = computeAxis(xOffset + (double)l2 * xScale + this->xCoord);
+        const int a = perm[ax.cell];
+        const int b = perm[(ax.cell + 1) & 255];
+        const __m256d x0 = _mm256_set1_pd(ax.frac);
+        const __m256d x1 = _mm256_set1_pd(ax.frac - 1.0);
+        const __m256d fx = _mm256_set1_pd(ax.fade);
+
+        for (int k3 = zStart; k3 < zStart + zSize; ++k3) {
+            const Axis az = computeAxis(zOffset + (double)k3 * zScale + this->zCoord);
+            const int i4 = az.cell;
+            const __m256d z0 = _mm256_set1_pd(az.frac);
+            const __m256d z1 = _mm256_set1_pd(az.frac - 1.0);
+            const __m256d fz = _mm256_set1_pd(az.fade);
+
+            for (int j = 0; j < ySize; j += 4) {
+                const __m256d y0 = _mm256_load_pd(&yl.gradY[j]);
+                const __m256d y1 = _mm256_sub_pd(y0, one);
+                const __m256d fy = _mm256_load_pd(&yl.fade[j]);
+
+                alignas(16) int hash[8][4];
+                hashLanes(perm, a, b, i4, &yl.cell[j], hash);
+                const __m256d d1 = lerp4(fx, grad4(hash[0], x0, y0, z0), grad4(hash[1], x1, y0, z0));
+                const __m256d d2 = lerp4(fx, grad4(hash[2], x0, y1, z0), grad4(hash[3], x1, y1, z0));
+                const __m256d d3 = lerp4(fx, grad4(hash[4], x0, y0, z1), grad4(hash[5], x1, y0, z1));
+                const __m256d d4 = lerp4(fx, grad4(hash[6], x0, y1, z1), grad4(hash[7], x1, y1, z1));
+
+                const __m256d d11 = lerp4(fy, d1, d2);
+                const __m256d d12 = lerp4(fy, d3, d4);
+                const __m256d d13 = lerp4(fz, d11, d12);
+                const __m256d result = _mm256_mul_pd(d13, d0);
+                double* out = noiseArray + i + j;
+                if (j + 4 <= ySize) {
+                    _mm256_storeu_pd(out, _mm256_add_pd(_mm256_loadu_pd(out), result));
+                } else {
+                    alignas(32) double tail[4];
+                    _mm256_store_pd(tail, result);
+                    for (int r = 0; r < ySize - j; r++) {
+                        out[r] += tail[r];
+                    }
+                }
+            }
+            i += ySize;
+        }
+    }
+}
+
+void NoiseGeneratorImproved::populateNoiseArraySse2(double* noiseArray, double xOffset, double yOffset, double zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, double noiseScale, int xStart, int yStart, int zStart) const {
+    if (ySize == 1) exit(1); // uses different code that's deleted
+    if (ySize > MAX_Y) {
+        populateNoiseArrayScalar(noiseArray, xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale, noiseScale, xStart, yStart, zStart);
+        return;
+    }
+    const uint8_t* perm = this->permutations.data();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d d0 = _mm_set1_pd(1.0 / noiseScale);
+    const YLattice yl = computeY(yOffset, yStart, ySize, yScale, this->yCoord, firstGradientY(yOffset, yScale, yStart));
+    int i = 0;
+
+    for (int l2 = xStart; l2 < xStart + xSize; ++l2) {
+        const Axis ax = computeAxis(xOffset + (double)l2 * xScale + this->xCoord);
+        const int a = perm[ax.cell];
+        const int b = perm[(ax.cell + 1) & 255];
+        const __m128d x0 = _mm_set1_pd(ax.frac);
+        const __m128d x1 = _mm_set1_pd(ax.frac - 1.0);
+        const __m128d fx = _mm_set1_pd(ax.fade);
+
+        for (int k3 = zStart; k3 < zStart + zSize; ++k3) {
+            const Axis az = computeAxis(zOffset + (double)k3 * zScale + this->zCoord);
+            const int i4 = az.cell;
+            const __m128d z0 = _mm_set1_pd(az.frac);
+            const __m128d z1 = _mm_set1_pd(az.frac - 1.0);
+            const __m128d fz = _mm_set1_pd(az.fade);
+
+            for (int j = 0; j < ySize; j += 4) {
+                int hash[8][4];
+                hashLanes(perm, a, b, i4, &yl.cell[j], hash);
+
+                alignas(16) double result[4];
+                for (int h = 0; h < 4; h += 2) {
+                    const __m128d y0 = _mm_load_pd(&yl.gradY[j + h]);
+                    const __m128d y1 = _mm_sub_pd(y0, one);
+                    const __m128d fy = _mm_load_pd(&yl.fade[j + h]);
+                    const __m128d d1 = lerp2(fx, grad2(&hash[0][h], x0, y0, z0), grad2(&hash[1][h], x1, y0, z0));
+                    const __m128d d2 = lerp2(fx, grad2(&hash[2][h], x0, y1, z0), grad2(&hash[3][h], x1, y1, z0));
+                    const __m128d d3 = lerp2(fx, grad2(&hash[4][h], x0, y0, z1), grad2(&hash[5][h], x1, y0, z1));
+                    const __m128d d4 = lerp2(fx, grad2(&hash[6][h], x0, y1, z1), grad2(&hash[7][h], x1, y1, z1));
+
+                    const __m128d d11 = lerp2(fy, d1, d2);
+                    const __m128d d12 = lerp2(fy, d3, d4);
+                    const __m128d d13 = lerp2(fz, d11, d12);
+                    _mm_store_pd(&result[h], _mm_mul_pd(d13, d0));
+                }
+                double* out = noiseArray + i + j;
+                for (int r = 0; r < 4 && j + r < ySize; r++) {
+                    out[r] += result[r];
+                }
+            }
+            i += ySize;
+        }
+    }
+}
+#endif
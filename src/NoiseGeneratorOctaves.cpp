@@ -1,27 +1,40 @@
 #include "NoiseGeneratorOctaves.h"
 
+#include <cmath>
+
 static int64_t lfloor(double value) {
     int64_t i = (int64_t)value;
     return value < (double)i ? i - 1L : i;
 }
 
-void NoiseGeneratorOctavesBase::generateNoiseOctaves0(double* noiseArray, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale) const {
-    double d3 = 1.0;
-
+void NoiseGeneratorOctavesBase::generateNoiseOctaves0(double* noiseArray, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const {
     for (int j = 0; j < this->octaves; ++j)
     {
-        double d0 = (double)xOffset * d3 * xScale;
-        double d1 = (double)yOffset * d3 * yScale;
-        double d2 = (double)zOffset * d3 * zScale;
-        long k = lfloor(d0);
-        long l = lfloor(d2);
-        d0 = d0 - (double)k;
-        d2 = d2 - (double)l;
-        k = k % 16777216L;
-        l = l % 16777216L;
-        d0 = d0 + (double)k;
-        d2 = d2 + (double)l;
-        this->generators[j].populateNoiseArray(noiseArray, d0, d1, d2, xSize, ySize, zSize, xScale * d3, yScale * d3, zScale * d3, d3);
-        d3 /= 2.0;
+        populateOctave(noiseArray, j, xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale, xStart, yStart, zStart);
     }
 }
+
+void NoiseGeneratorOctavesBase::populateOctave(double* noiseArray, int octave, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const {
+    // this used to be halved once per octave, which is exact so it's the same as computing it directly
+    const double d3 = std::ldexp(1.0, -octave);
+    double d0 = (double)xOffset * d3 * xScale;
+    double d1 = (double)yOffset * d3 * yScale;
+    double d2 = (double)zOffset * d3 * zScale;
+    long k = lfloor(d0);
+    long l = lfloor(d2);
+    d0 = d0 - (double)k;
+    d2 = d2 - (double)l;
+    k = k % 16777216L;
+    l = l % 16777216L;
+    d0 = d0 + (double)k;
+    d2 = d2 + (double)l;
+    this->generators[octave].populateNoiseArray(noiseArray, d0, d1, d2, xSize, ySize, zSize, xScale * d3, yScale * d3, zScale * d3, d3, xStart, yStart, zStart);
+}
+
+std::vector<double> NoiseGeneratorOctavesBase::generateNoiseOctaves(int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const {
+    std::vector<double> noiseArray(xSize * ySize * zSize);
+
+    generateNoiseOctaves0(noiseArray.data(), xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale, xStart, yStart, zStart);
+
+    return noiseArray;
+}
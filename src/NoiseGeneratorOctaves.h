@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include "NoiseGeneratorImproved.h"
 #include "Random.h"
@@ -18,8 +19,13 @@ struct NoiseGeneratorOctavesBase {
 
     template<int xSize, int ySize, int zSize>
     std::array<double, xSize * ySize * zSize> generateNoiseOctaves(int xOffset, int yOffset, int zOffset, double xScale, double yScale, double zScale) const;
+    // xStart, yStart and zStart are passed to populateNoiseArray
+    std::vector<double> generateNoiseOctaves(int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const;
+    // Adds one octave to noiseArray. generateNoiseOctaves adds every octave in order to a zeroed array, so the octaves
+    // can be computed separately (on different threads) and summed in that order later with the exact same result.
+    void populateOctave(double* noiseArray, int octave, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const;
 private:
-    void generateNoiseOctaves0(double* noiseArrays, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale) const;
+    void generateNoiseOctaves0(double* noiseArrays, int xOffset, int yOffset, int zOffset, int xSize, int ySize, int zSize, double xScale, double yScale, double zScale, int xStart, int yStart, int zStart) const;
 };
 
 template<size_t Octaves>
@@ -46,7 +52,7 @@ template<int xSize, int ySize, int zSize>
 std::array<double, xSize * ySize * zSize> NoiseGeneratorOctavesBase::generateNoiseOctaves(int xOffset, int yOffset, int zOffset, double xScale, double yScale, double zScale) const {
     std::array<double, xSize * ySize * zSize> noiseArray{};
 
-    generateNoiseOctaves0(noiseArray.data(), xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale);
+    generateNoiseOctaves0(noiseArray.data(), xOffset, yOffset, zOffset, xSize, ySize, zSize, xScale, yScale, zScale, 0, 0, 0);
 
     return noiseArray;
 }
\ No newline at end of file
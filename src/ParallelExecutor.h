@@ -1,99 +1,88 @@
 #pragma once
 
 #include <cstdio>
-#include <thread>
 #include <functional>
 #include <array>
 #include <tuple>
-#include <condition_variable>
-#include <mutex>
 #include <type_traits>
+#include <memory>
+#include <atomic>
 
+#include "TaskPool.h"
 
-struct Worker {
-    std::condition_variable& condition;
-    std::mutex& mutex;
-    std::function<void()> task;
-    std::thread thread;
-    std::atomic_bool stopRequest;
+// Runs Threads tasks at the same time on a TaskPool, the calling thread runs the last one and helps with the rest.
+// It has no threads of its own so executors are cheap and nesting them doesn't start more threads.
+template<int Threads>
+struct ParallelExecutor {
+    // null for TaskPool::shared()
+    std::shared_ptr<TaskPool> pool;
+    bool threaded;
 
-    Worker(std::condition_variable& cv, std::mutex& m): condition(cv), mutex(m), thread([this] {
-        while (true) {
-            std::unique_lock lock(this->mutex);
-            condition.wait(lock, [this] { return stopRequest.load(std::memory_order_acquire) || static_cast<bool>(this->task); });
-            if (stopRequest.load(std::memory_order_acquire)) return;
+    ParallelExecutor(): ParallelExecutor(true) {}
+    // Without threads compute runs the tasks one after another, for callers that already have a thread per core
+    explicit ParallelExecutor(bool threaded): threaded(threaded) {}
+    explicit ParallelExecutor(std::shared_ptr<TaskPool> pool): pool(std::move(pool)), threaded(true) {}
 
-            this->task();
-            this->task = nullptr;
-        }
-    }) {}
-
-    void stop() {
-        stopRequest.store(true, std::memory_order_release);
+    // null if the tasks should run on the calling thread
+    std::shared_ptr<TaskPool> activePool() const {
+        // the shared pool can be replaced while a compute runs so it gets its own reference
+        const std::shared_ptr<TaskPool> p = !threaded ? nullptr : pool ? pool : TaskPool::shared();
+        return p && p->threads() > 0 ? p : nullptr;
     }
 
-    void join() {
-        thread.join();
-    }
-};
-
-#if 1
-template<int Threads>
-struct ParallelExecutor {
-    std::condition_variable condition_variable;
-    std::mutex mutex;
-    std::array<Worker, Threads - 1> workers = std::apply([&](auto... uwu) {
-        return std::array{((void) uwu, Worker{condition_variable, mutex})...};
-    }, std::array<char, Threads -1>{});
-
     template<typename... Fn> requires (sizeof...(Fn) == Threads)
     __attribute__((noinline)) auto compute(Fn&&... tasks) {
+        const std::shared_ptr<TaskPool> p = activePool();
+        if (!p) {
+            // braced init runs them in order
+            return std::tuple<std::invoke_result_t<Fn>...>{tasks()...};
+        }
         // Indexing parameter packs is aids
         std::tuple args = std::make_tuple(std::forward<Fn>(tasks)...);
 
         std::tuple<std::invoke_result_t<Fn>...> results;
         std::atomic_int counter = 0;
+        TaskPool& taskPool = *p;
 
         [&]<size_t... I>(std::index_sequence<I...>) {
-            std::lock_guard lock(mutex);
-            ([&] {
-                Worker& worker = workers[I];
-                auto& r = std::get<I>(results);
-                worker.task = [&] {
-                    r = std::get<I>(args)();
-                    // signal that we are finished
-                    counter++;
-                };
-            }(), ...);
+            (taskPool.submit([&results, &args, &counter, &taskPool] {
+                std::get<I>(results) = std::get<I>(args)();
+                // signal that we are finished
+                counter.fetch_add(1, std::memory_order_release);
+                taskPool.wake();
+            }), ...);
         }(std::make_index_sequence<Threads - 1>{});
-        this->condition_variable.notify_all();
         // take advantage of the calling tread
         std::get<Threads - 1>(results) = std::get<Threads - 1>(args)();
-        counter++;
+        counter.fetch_add(1, std::memory_order_release);
 
-        //while (counter != Threads); // wait
-        while (counter.load(std::memory_order_acquire) != Threads);
+        // runs our own tasks that nobody took yet (or someone else's) instead of spinning
+        taskPool.helpUntil([&] { return counter.load(std::memory_order_acquire) == Threads; });
 
         return results;
     }
 
-    ~ParallelExecutor() {
-        for (auto& w : workers) {
-            w.stop();
+    // Calls job(i) for every i in [0, count) at the same time and returns once they all returned, for batches whose size
+    // isn't known at compile time. The calling thread runs job(0).
+    template<typename Fn>
+    void forEach(int count, Fn&& job) {
+        const std::shared_ptr<TaskPool> p = activePool();
+        if (!p || count <= 1) {
+            for (int i = 0; i < count; i++) job(i);
+            return;
         }
-        this->condition_variable.notify_all();
-        for (auto& w : workers) {
-            w.join();
+        std::atomic_int counter = 0;
+        TaskPool& taskPool = *p;
+        for (int i = 1; i < count; i++) {
+            taskPool.submit([&job, &counter, &taskPool, i] {
+                job(i);
+                counter.fetch_add(1, std::memory_order_release);
+                taskPool.wake();
+            });
         }
+        job(0);
+        counter.fetch_add(1, std::memory_order_release);
+        taskPool.helpUntil([&] { return counter.load(std::memory_order_acquire) == count; });
     }
 };
 
-#else
-template<int Threads>
-struct ParallelExecutor {
-    template<typename... Fn> requires (sizeof...(Fn) == Threads)
-    auto compute(Fn&&... tasks) {
-        return std::tuple{tasks()...};
-    }
-};
-#endif
@@ -1,5 +1,8 @@
 #include "PathFinder.h"
 #include "BinaryHeapOpenSet.h"
+#include "HeapOpenSet.h"
+#include "BucketOpenSet.h"
+#include "PathNodeArena.h"
 #include "ChunkGen.h"
 #include "baritone.h"
 
@@ -10,44 +13,33 @@
 #include <functional>
 #include <queue>
 #include <unordered_set>
+#include <bit>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 constexpr bool VERBOSE = false;
 
-// never returns null
-PathNode* getNodeAtPosition(map_t<NodePos, std::unique_ptr<PathNode>>& map, const NodePos& pos, const BlockPos& goal) {
-    auto iter = map.find(pos);
-    if (iter == map.end()) {
-        auto node = std::make_unique<PathNode>(pos, goal);
-        auto it = map.emplace(pos, std::move(node));
-        assert(it.second);
-        return it.first->second.get();
-    } else {
-        return iter->second.get();
+// the nodes from the start of the search to end
+std::vector<PathNode> nodesFromStart(PathNodeArena& nodeArena, const PathNode* end) {
+    std::vector<PathNode> tempNodes;
+    for (uint32_t current = end->index; current != PathNode::NONE; current = nodeArena[current].previous) {
+        tempNodes.push_back(nodeArena[current]);
     }
-}
-
 
-Path createPath(map_t<NodePos, std::unique_ptr<PathNode>>& map, const PathNode* start, const PathNode* end,
-                const BlockPos& startPos, const BlockPos& goal, Path::Type pathType) {
-    std::vector<std::unique_ptr<PathNode>> tempNodes;
-    std::vector<BlockPos> tempPath;
-
-    const PathNode* current = end;
-    while (current) {
-        auto& uniqueptr = map.at(current->pos);
-        tempNodes.push_back(std::move(uniqueptr));
-        tempPath.push_back(current->pos.absolutePosCenter());
-        current = current->previous;
-    }
-
-    //auto nodes = decltype(tempNodes)(tempPath.rbegin(), tempPath.rend());
     auto nodes = decltype(tempNodes){};
     nodes.reserve(tempNodes.size());
     std::move(tempNodes.rbegin(), tempNodes.rend(), std::back_inserter(nodes));
+    return nodes;
+}
 
-    auto path = decltype(tempPath){};
-    path.reserve(tempPath.size());
-    std::move(tempPath.rbegin(), tempPath.rend(), std::back_inserter(path));
+Path createPath(std::vector<PathNode>&& nodes, const BlockPos& startPos, const BlockPos& goal, Path::Type pathType) {
+    auto path = std::vector<BlockPos>{};
+    path.reserve(nodes.size());
+    for (const PathNode& node : nodes) {
+        path.push_back(node.pos.absolutePosCenter());
+    }
 
     return Path{
             pathType,
@@ -58,6 +50,24 @@ Path createPath(map_t<NodePos, std::unique_ptr<PathNode>>& map, const PathNode*
     };
 }
 
+Path createPath(PathNodeArena& nodeArena, const PathNode* start, const PathNode* end,
+                const BlockPos& startPos, const BlockPos& goal, Path::Type pathType) {
+    return createPath(nodesFromStart(nodeArena, end), startPos, goal, pathType);
+}
+
+// The path of a bidirectional search: the forward nodes up to forwardEnd and then the backward ones (which were
+// searched from the goal) from backwardEnd to the goal. The ends are usually the same node of both searches.
+Path createPath(PathNodeArena& forwardArena, const PathNode* forwardEnd, PathNodeArena& backwardArena, const PathNode* backwardEnd,
+                const BlockPos& startPos, const BlockPos& goal, Path::Type pathType) {
+    std::vector<PathNode> nodes = nodesFromStart(forwardArena, forwardEnd);
+    for (uint32_t current = backwardEnd->index; current != PathNode::NONE; current = backwardArena[current].previous) {
+        const PathNode& node = backwardArena[current];
+        if (node.pos == nodes.back().pos) continue;
+        nodes.push_back(node);
+    }
+    return createPath(std::move(nodes), startPos, goal, pathType);
+}
+
 const Chunk& getRealChunkFromCacheOrFakeChunkMaybeGen(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos, FakeChunkMode mode) {
     if (mode == FakeChunkMode::GENERATE) {
         return getOrGenChunk(ctx, executor, pos);
@@ -65,24 +75,270 @@ const Chunk& getRealChunkFromCacheOrFakeChunkMaybeGen(Context& ctx, ChunkGenExec
     return getRealChunkOrDefault(ctx, pos, mode == FakeChunkMode::SOLID);
 }
 
+// bits minSection to maxSection
+constexpr uint8_t sectionMask(int minSection, int maxSection) {
+    return minSection > maxSection ? 0 : ((1u << (maxSection + 1)) - 1) & ~((1u << minSection) - 1);
+}
+constexpr uint8_t ALL_SECTIONS = sectionMask(0, GEN_SECTIONS - 1);
+
+// the sections in the mask that a cached chunk doesn't have yet
+uint8_t missingSections(const Context& ctx, const ChunkPos& pos, ChunkState state, uint8_t sections) {
+    if (state != ChunkState::PARTIAL) return 0;
+    return sections & ~ctx.partialSections.at(pos);
+}
+
+// the chunk stops being PARTIAL once it has every section
+void addSections(Context& ctx, const ChunkPos& pos, std::pair<ChunkState, Chunk*>& entry, uint8_t sections) {
+    auto it = ctx.partialSections.find(pos);
+    it->second |= sections;
+    if (it->second == ALL_SECTIONS) {
+        entry.first = ChunkState::FAKE;
+        ctx.partialSections.erase(it);
+    }
+}
+
+Chunk& uncompressedChunk(Context& ctx, const ChunkPos& pos, std::pair<ChunkState, Chunk*>& entry) {
+    if (!entry.second) [[unlikely]] {
+        entry.second = ctx.compressor.decompress(pos, *ctx.chunkAllocator);
+        if (!entry.second) {
+            // shouldn't happen, but the compressor only takes FAKE chunks so it can be generated again
+            entry.second = ctx.chunkAllocator->allocate();
+            ctx.generator.generateChunk(pos.x, pos.z, *entry.second, ctx.executor);
+        }
+    }
+    if (entry.first == ChunkState::PARTIAL) [[unlikely]] {
+        const uint8_t missing = ALL_SECTIONS & ~ctx.partialSections.at(pos);
+        // the sections in between that it already has are written again with the same blocks
+        ctx.generator.generateChunks(pos.x, pos.z, 1, 1, &entry.second, ctx.executor, std::countr_zero(missing), std::bit_width(missing) - 1);
+        addSections(ctx, pos, entry, missing);
+    }
+    return *entry.second;
+}
+
 const Chunk& getOrGenChunk(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos) {
     ctx.cacheMutex.lock();
     auto it = ctx.chunkCache.find(pos);
     if (it != ctx.chunkCache.end()) {
-        Chunk* chunk = it->second.second;
+        Chunk& chunk = uncompressedChunk(ctx, pos, it->second);
+        ctx.compressor.touch(pos);
         ctx.cacheMutex.unlock();
-        return *chunk;
+        return chunk;
     } else {
         Chunk* chunk = ctx.chunkAllocator->allocate();
         ctx.cacheMutex.unlock();
         ctx.generator.generateChunk(pos.x, pos.z, *chunk, executor);
         ctx.cacheMutex.lock();
         ctx.chunkCache.emplace(pos, std::pair{ChunkState::FAKE, chunk});
+        ctx.compressor.touch(pos);
         ctx.cacheMutex.unlock();
         return *chunk;
     }
 }
 
+namespace {
+    // a tile whose chunks are being generated outside the cache lock
+    struct TileWork {
+        ChunkPos tile;
+        std::array<Chunk*, GEN_TILE_SIZE * GEN_TILE_SIZE> chunks{}; // indexed like ChunkGeneratorHell::generateTile
+        std::array<bool, GEN_TILE_SIZE * GEN_TILE_SIZE> fresh{}; // allocated here, the rest are in the cache already
+        int first, last; // the sections to generate
+    };
+
+    // Finds the chunks of the tile of pos that don't have all the sections [minSection, maxSection] and allocates the
+    // missing ones. Returns false if there's nothing to generate.
+    bool claimTile(Context& ctx, const ChunkPos& pos, int minSection, int maxSection, TileWork& work) {
+        work.tile = tileOf(pos);
+        const uint8_t wanted = sectionMask(minSection, maxSection);
+        if (!wanted) return false;
+        uint8_t missing = 0;
+        ctx.cacheMutex.lock();
+        for (int i = 0; i < GEN_TILE_SIZE * GEN_TILE_SIZE; i++) {
+            const ChunkPos cpos{work.tile.x + i / GEN_TILE_SIZE, work.tile.z + i % GEN_TILE_SIZE};
+            auto it = ctx.chunkCache.find(cpos);
+            if (it == ctx.chunkCache.end()) {
+                work.chunks[i] = ctx.chunkAllocator->allocate();
+                work.fresh[i] = true;
+                missing |= wanted;
+            } else if (const uint8_t sections = missingSections(ctx, cpos, it->second.first, wanted)) {
+                work.chunks[i] = it->second.second;
+                missing |= sections;
+            }
+        }
+        ctx.cacheMutex.unlock();
+        // the sections in between that a chunk already has are written again with the same blocks
+        work.first = std::countr_zero(missing);
+        work.last = std::bit_width(missing) - 1;
+        return missing != 0;
+    }
+
+    // puts the generated chunks of a claimed tile in the cache
+    void insertTile(Context& ctx, const TileWork& work) {
+        const uint8_t generated = sectionMask(work.first, work.last);
+        ctx.cacheMutex.lock();
+        for (int i = 0; i < GEN_TILE_SIZE * GEN_TILE_SIZE; i++) {
+            if (!work.chunks[i]) continue;
+            const ChunkPos cpos{work.tile.x + i / GEN_TILE_SIZE, work.tile.z + i % GEN_TILE_SIZE};
+            if (!work.fresh[i]) {
+                addSections(ctx, cpos, ctx.chunkCache.at(cpos), generated);
+                continue;
+            }
+            const ChunkState state = generated == ALL_SECTIONS ? ChunkState::FAKE : ChunkState::PARTIAL;
+            if (ctx.chunkCache.emplace(cpos, std::pair{state, work.chunks[i]}).second) {
+                if (state == ChunkState::PARTIAL) ctx.partialSections.insert_or_assign(cpos, generated);
+                ctx.compressor.touch(cpos);
+            } else {
+                // someone else generated it first
+                ctx.chunkAllocator->free(work.chunks[i]);
+            }
+        }
+        ctx.cacheMutex.unlock();
+    }
+}
+
+void generateTile(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos, int minSection, int maxSection) {
+    TileWork work;
+    if (!claimTile(ctx, pos, minSection, maxSection, work)) return;
+    ctx.generator.generateTile(work.tile.x, work.tile.z, GEN_TILE_SIZE, work.chunks.data(), executor, work.first, work.last);
+    insertTile(ctx, work);
+}
+
+void generateTiles(Context& ctx, ChunkGenExec& executor, std::span<const ChunkPos> tiles, int minSection, int maxSection) {
+    std::vector<TileWork> work(tiles.size());
+    std::vector<ChunkGeneratorHell::TileRequest> requests;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (!claimTile(ctx, tiles[i], minSection, maxSection, work[i])) continue;
+        requests.push_back({work[i].tile.x, work[i].tile.z, GEN_TILE_SIZE, work[i].chunks.data(), work[i].first, work[i].last});
+    }
+    if (requests.empty()) return;
+    ctx.generator.generateTiles(requests, executor);
+    for (const TileWork& w : work) {
+        if (std::any_of(w.chunks.begin(), w.chunks.end(), [](Chunk* c) { return c != nullptr; })) insertTile(ctx, w);
+    }
+}
+
+size_t pregenerateRegion(Context& ctx, const ChunkPos& min, const ChunkPos& max, int threads) {
+    struct Job {
+        ChunkPos tile;
+        std::array<Chunk*, GEN_TILE_SIZE * GEN_TILE_SIZE> chunks{}; // indexed like generateTile
+    };
+    auto chunkPos = [](const Job& job, int i) {
+        return ChunkPos{job.tile.x + i / GEN_TILE_SIZE, job.tile.z + i % GEN_TILE_SIZE};
+    };
+
+    // the chunks are allocated here because the allocator can only be used by one thread
+    std::vector<Job> jobs;
+    size_t total = 0;
+    ctx.cacheMutex.lock();
+    const ChunkPos firstTile = tileOf(min);
+    const ChunkPos lastTile = tileOf(max);
+    for (int64_t x = firstTile.x; x <= lastTile.x; x += GEN_TILE_SIZE) {
+        for (int64_t z = firstTile.z; z <= lastTile.z; z += GEN_TILE_SIZE) {
+            Job job{{(int) x, (int) z}};
+            bool any = false;
+            for (int i = 0; i < GEN_TILE_SIZE * GEN_TILE_SIZE; i++) {
+                const ChunkPos cpos = chunkPos(job, i);
+                if (cpos.x < min.x || cpos.x > max.x || cpos.z < min.z || cpos.z > max.z) continue;
+                auto it = ctx.chunkCache.find(cpos);
+                // partial chunks are replaced with whole ones
+                if (it != ctx.chunkCache.end() && it->second.first != ChunkState::PARTIAL) continue;
+                job.chunks[i] = ctx.chunkAllocator->allocate();
+                any = true;
+                total++;
+            }
+            if (any) jobs.push_back(job);
+        }
+    }
+    ctx.chunkCache.reserve(ctx.chunkCache.size() + total);
+    ctx.cacheMutex.unlock();
+    ctx.regionChunksDone.store(0, std::memory_order_relaxed);
+    ctx.regionChunksTotal.store(total, std::memory_order_relaxed);
+    if (jobs.empty()) return 0;
+
+    TaskPool& pool = *ctx.taskPool;
+    // more tasks than threads would only wait for the others
+    if (threads <= 0 || threads > pool.threads() + 1) threads = pool.threads() + 1;
+    threads = (int) std::min<size_t>(threads, jobs.size());
+
+    std::atomic_size_t nextJob{0};
+    std::mutex mutex;
+    std::vector<size_t> finished; // generated jobs that aren't in the cache yet
+    int running = threads;
+    // Every task generates one tile and queues the next one, so there are never more than threads of them. Any thread
+    // that waits on the pool can take one (including other searches), that only holds it up for a tile.
+    std::function<void()> generateNext = [&, taskPool = &pool] {
+        const size_t i = ctx.cancelFlag.test() ? jobs.size() : nextJob.fetch_add(1, std::memory_order_relaxed);
+        if (i >= jobs.size()) {
+            {
+                std::lock_guard lock(mutex);
+                running--;
+            }
+            // nothing on the stack of pregenerateRegion can be used after running is 0
+            taskPool->wake();
+            return;
+        }
+        // every pool thread already has a task so the noise isn't split up any further
+        ChunkGenExec executor{false};
+        ctx.generator.generateTile(jobs[i].tile.x, jobs[i].tile.z, GEN_TILE_SIZE, jobs[i].chunks.data(), executor);
+        {
+            std::lock_guard lock(mutex);
+            finished.push_back(i);
+        }
+        taskPool->submit(generateNext);
+        taskPool->wake();
+    };
+    for (int t = 0; t < threads; t++) {
+        pool.submit(generateNext);
+    }
+
+    // this thread only moves finished tiles into the cache, in batches so the cache lock isn't taken for every tile
+    size_t inserted = 0;
+    std::vector<size_t> batch;
+    while (true) {
+        // a tile this thread generates in here is inserted right after
+        pool.helpUntil([&] {
+            std::lock_guard lock(mutex);
+            return !finished.empty() || running == 0;
+        });
+        {
+            std::lock_guard lock(mutex);
+            if (finished.empty()) break;
+            batch.swap(finished);
+        }
+        ctx.cacheMutex.lock();
+        for (size_t i : batch) {
+            for (int j = 0; j < GEN_TILE_SIZE * GEN_TILE_SIZE; j++) {
+                Chunk* chunk = jobs[i].chunks[j];
+                if (!chunk) continue;
+                const ChunkPos cpos = chunkPos(jobs[i], j);
+                auto [it, emplaced] = ctx.chunkCache.try_emplace(cpos, std::pair{ChunkState::FAKE, chunk});
+                if (!emplaced) {
+                    if (it->second.first != ChunkState::PARTIAL) {
+                        // someone else generated it first
+                        ctx.chunkAllocator->free(chunk);
+                        continue;
+                    }
+                    ctx.chunkAllocator->free(it->second.second);
+                    ctx.partialSections.erase(cpos);
+                    it->second = std::pair{ChunkState::FAKE, chunk};
+                }
+                ctx.compressor.touch(cpos);
+                inserted++;
+            }
+        }
+        ctx.cacheMutex.unlock();
+        ctx.regionChunksDone.store(inserted, std::memory_order_relaxed);
+        batch.clear();
+    }
+
+    // the jobs that nobody took before it was cancelled
+    for (size_t i = std::min(nextJob.load(), jobs.size()); i < jobs.size(); i++) {
+        for (Chunk* chunk : jobs[i].chunks) {
+            if (chunk) ctx.chunkAllocator->free(chunk);
+        }
+    }
+    return inserted;
+}
+
 const Chunk& getRealChunkOrDefault(Context& ctx, const ChunkPos& pos, bool solid) {
     auto it = ctx.chunkCache.find(pos);
     if (it != ctx.chunkCache.end()) {
@@ -94,11 +350,16 @@ const Chunk& getRealChunkOrDefault(Context& ctx, const ChunkPos& pos, bool solid
     }
 }
 
-std::pair<ChunkState, const Chunk&> getChunkOrAir(Context& ctx, const ChunkPos& pos) {
+// partial chunks are returned as they are if allowPartial is set, the caller has to make sure the sections it uses exist
+std::pair<ChunkState, const Chunk&> getChunkOrAir(Context& ctx, const ChunkPos& pos, bool allowPartial) {
     auto it = ctx.chunkCache.find(pos);
     if (it != ctx.chunkCache.end()) {
         auto& [state, chunk] = it->second;
-        return {state, *chunk};
+        if (allowPartial && state == ChunkState::PARTIAL) {
+            return {state, *chunk};
+        }
+        const Chunk& uncompressed = uncompressedChunk(ctx, pos, it->second);
+        return {state, uncompressed};
     } else {
         return {ChunkState::FAKE, AIR_CHUNK};
     }
@@ -212,7 +473,7 @@ void growThenIterateInner(const Chunk& chunk, ChunkState state, const NodePos& p
 template<Face face, Size minSize>
 void growThenIterateOuter(const Chunk& chunk, ChunkState state, const NodePos& pos, auto& callback) {
 #define CASE(sz) case sz: growThenIterateInner<face, sz, minSize>(chunk, state, pos, callback); return;
-    switch (pos.size) {
+    switch (pos.size()) {
         CASE(Size::X1)
         CASE(Size::X2)
         CASE(Size::X4)
@@ -227,14 +488,23 @@ bool isInBounds(int worldHeight, const BlockPos& pos) {
 }
 
 constexpr double MIN_DIST_PATH = 5; // might want to increase this
+// a node is only reopened if its cost goes down by more than this
+constexpr double MIN_IMPROVEMENT = 0.01;
+
+// A lower bound of the cost from pos to a node that contains target: a step goes at most 16 blocks between the centers
+// of two cubes and costs at least minStepCost, and the center of a node that contains target can be up to 14 blocks away.
+// Unlike PathNode::heuristic it's consistent.
+double hopLowerBound(const NodePos& pos, const BlockPos& target, double minStepCost) {
+    return std::max(0.0, pos.absolutePosCenter().distanceTo(target) - 14) / 16 * minStepCost;
+}
 
 std::optional<Path>
-bestPathSoFar(map_t<NodePos, std::unique_ptr<PathNode>>& map, const PathNode* start, const PathNode* end,
+bestPathSoFar(PathNodeArena& nodeArena, const PathNode* start, const PathNode* end,
               const BlockPos& startPos, const BlockPos& goal) {
     const double distSq = startPos.distanceToSq(end->pos.absolutePosCenter());
 
     if (distSq > MIN_DIST_PATH * MIN_DIST_PATH) {
-        return createPath(map, start, end, startPos, goal, Path::Type::SEGMENT);
+        return createPath(nodeArena, start, end, startPos, goal, Path::Type::SEGMENT);
     } else {
         if (VERBOSE) {
             std::cout << "Path took too long and got nowhere\n";
@@ -245,7 +515,7 @@ bestPathSoFar(map_t<NodePos, std::unique_ptr<PathNode>>& map, const PathNode* st
     }
 
     // assume there's always a way
-    //return createPath(map, start, end, startPos, goal, Path::Type::SEGMENT);
+    //return createPath(nodeArena, start, end, startPos, goal, Path::Type::SEGMENT);
 }
 
 bool closeToGoal(const NodePos& node, const BlockPos& goal) {
@@ -255,7 +525,7 @@ bool closeToGoal(const NodePos& node, const BlockPos& goal) {
 bool inGoal(const NodePos& node, const BlockPos& goal) {
     [[likely]] if (!closeToGoal(node, goal)) return false;
     auto c1 = node.absolutePosZero();
-    auto c2 = c1 + width(node.size);
+    auto c2 = c1 + width(node.size());
     return goal.x >= c1.x && goal.x <= c2.x &&
             goal.y >= c1.y && goal.y <= c2.y &&
             goal.z >= c1.z && goal.z <= c2.z;
@@ -274,6 +544,7 @@ std::chrono::milliseconds tryLoadRegionNative(Context& ctx, ChunkPos pos) {
 
         auto [data, dim] = file.value();
         parseBaritoneRegion(*ctx.chunkAllocator, ctx.chunkCache, regionPos, data, dim);
+        ctx.incrementalSearch.chunksChanged({regionPos.x * 32, regionPos.z * 32}, {regionPos.x * 32 + 31, regionPos.z * 32 + 31});
 
         auto t2 = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
@@ -283,124 +554,232 @@ std::chrono::milliseconds tryLoadRegionNative(Context& ctx, ChunkPos pos) {
     return {};
 }
 
-std::atomic_flag cancelFlag;
+// how many tiles along the start -> goal line are pregenerated when a search starts
+constexpr int PREGEN_CORRIDOR_TILES = 20;
+// how many tiles past the best node towards the goal are pregenerated when it moves to another tile
+constexpr int PREGEN_FRONTIER_TILES = 3;
 
-std::optional<Path> findPathSegment(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
-    const auto fakeChunkMode = airIfFake ? FakeChunkMode::AIR : FakeChunkMode::GENERATE;
-    const auto goalCenter = goal.absolutePosCenter();
-    const auto startCenter = start.absolutePosCenter();
-    if (VERBOSE) std::cout << "distance = " << start.absolutePosCenter().distanceTo(goalCenter) << '\n';
+// Asks the pregenerator for the tiles on the line from -> to and the ones next to them, nearest first
+void requestCorridor(Context& ctx, const BlockPos& from, const BlockPos& to, int maxTiles, bool urgent) {
+    constexpr int tileWidth = GEN_TILE_SIZE * 16;
+    const double dx = to.x - from.x;
+    const double dz = to.z - from.z;
+    const double length = std::sqrt(dx * dx + dz * dz);
+    const int steps = std::min(maxTiles, (int) (length / tileWidth) + 1);
+    // the sides are perpendicular to the main axis of the line
+    const bool alongX = std::abs(dx) >= std::abs(dz);
+    std::vector<ChunkPos> tiles;
+    for (int i = 0; i < steps; i++) {
+        const double t = length > 0 ? std::min(1.0, i * tileWidth / length) : 0;
+        const ChunkPos tile = tileOf(BlockPos{(int) (from.x + dx * t), 0, (int) (from.z + dz * t)}.toChunkPos());
+        tiles.push_back(tile);
+        tiles.push_back(alongX ? ChunkPos{tile.x, tile.z - GEN_TILE_SIZE} : ChunkPos{tile.x - GEN_TILE_SIZE, tile.z});
+        tiles.push_back(alongX ? ChunkPos{tile.x, tile.z + GEN_TILE_SIZE} : ChunkPos{tile.x + GEN_TILE_SIZE, tile.z});
+    }
+    // urgent tiles go to the front of the queue so the nearest one has to be requested last
+    if (urgent) std::reverse(tiles.begin(), tiles.end());
+    for (const ChunkPos& tile : tiles) {
+        ctx.pregenerator.request(ctx.chunkCache, tile, urgent);
+    }
+}
 
-    map_t<NodePos, std::unique_ptr<PathNode>> map;
-    map_t<ChunkPos, bool> doneFull;
-    BinaryHeapOpenSet openSet;
+// One direction of a search, from the start to the goal or (in a bidirectional search) from the goal to the start
+template<typename OpenSet>
+struct SearchSide {
+    PathNodeArena nodeArena;
+    OpenSet openSet{nodeArena};
+    const BlockPos startCenter;
+    const BlockPos targetCenter;
+    PathNode* const startNode;
+    PathNode* bestSoFar;
+    double bestHeuristicSoFar;
+    // bestSoFar is too close to the start to be worth returning
+    bool failing = true;
+    int fakeChunkVisits = 0; // if this gets too high we return
+    ChunkPos frontierTile;
+    // cost + hopLowerBound of the nodes when they are opened (only in a bidirectional search), the entries whose node
+    // has been expanded or got cheaper since then are skipped
+    struct Bound {
+        double bound;
+        float cost;
+        uint32_t index;
 
-    PathNode* const startNode = getNodeAtPosition(map, start, goal.absolutePosZero());
-    tryLoadRegionNative(ctx, start.absolutePosZero().toChunkPos());
-    startNode->cost = 0;
-    startNode->combinedCost = startNode->estimatedCostToGoal;
-    openSet.insert(startNode);
-    getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executors[0], start.absolutePosZero().toChunkPos(), fakeChunkMode);
+        bool operator>(const Bound& other) const {
+            return this->bound > other.bound;
+        }
+    };
+    std::priority_queue<Bound, std::vector<Bound>, std::greater<>> bounds;
 
-    PathNode* bestSoFar = startNode;
-    double bestHeuristicSoFar = startNode->estimatedCostToGoal;
+    SearchSide(const NodePos& from, const NodePos& to):
+        nodeArena(PathNode::heuristic(from, to.absolutePosZero())),
+        startCenter(from.absolutePosCenter()), targetCenter(to.absolutePosCenter()),
+        startNode(nodeArena.getOrCreate(from, to.absolutePosZero())), frontierTile(tileOf(startCenter.toChunkPos()))
+    {
+        startNode->cost = 0;
+        startNode->combinedCost = startNode->estimatedCostToGoal;
+        openSet.insert(startNode);
+        bestSoFar = startNode;
+        bestHeuristicSoFar = startNode->estimatedCostToGoal;
+    }
 
-    using namespace std::chrono_literals;
-    const auto startTime = std::chrono::system_clock::now();
-    const auto primaryTimeoutTime = startTime + 500ms;
-    const auto timeout = timeoutMs != 0 ? std::chrono::milliseconds{timeoutMs} : 30s;
-    const auto failureTimeout = startTime + timeout;
+    // the lowest cost + hopLowerBound of the open nodes, no path through them can cost less
+    double lowestBound() {
+        while (!bounds.empty()) {
+            const Bound& top = bounds.top();
+            const PathNode& node = nodeArena[top.index];
+            if (node.isOpen() && node.cost == top.cost) return top.bound;
+            bounds.pop();
+        }
+        return PathNode::COST_INF;
+    }
+};
+
+// What both directions of a search share
+template<typename OpenSet>
+struct Search {
+    Context& ctx;
+    const bool x4Min;
+    const bool airIfFake;
+    const double fakeChunkCost;
+    const double minStepCost;
+    const bool pregenerate;
+    const bool lazySections;
+    const bool symmetryPruning;
+    // chunks (and sections if they are generated lazily) whose neighbors have been generated
+    map_t<BlockPos, bool> doneFull;
     std::chrono::milliseconds timeDoingIO{};
+    // the cheapest path through a node that both directions have reached and that node in each of them, or the forward
+    // node in the goal and null if the cheapest path is one the forward direction found on its own
+    double meetCost = PathNode::COST_INF;
+    PathNode* forwardMeet = nullptr;
+    PathNode* backwardMeet = nullptr;
 
-    bool failing = true;
-    int numNodes = 0;
-    int fakeChunkVisits = 0; // if this gets too high we return
-    while (!openSet.isEmpty()) {
-        constexpr int timeCheckInterval = 1 << 6;
-        if ((numNodes & (timeCheckInterval - 1)) == 0) { // only call this once every 64 nodes
-            auto now = std::chrono::system_clock::now() - timeDoingIO;
+    Search(Context& ctx, bool x4Min, bool airIfFake, double fakeChunkCost):
+        ctx(ctx), x4Min(x4Min), airIfFake(airIfFake), fakeChunkCost(fakeChunkCost), minStepCost(std::min(1.0, fakeChunkCost)),
+        pregenerate(!airIfFake && ctx.pregenerator.enabled()), lazySections(!airIfFake && ctx.lazySections),
+        symmetryPruning(ctx.symmetryPruning) {}
 
-            if (now >= failureTimeout || (!failing && now >= primaryTimeoutTime)) {
-                break;
-            } else if (cancelFlag.test()) {
-                return {};
-            }
-        }
+    struct NeighborChunks {
+        // the chunk of the neighbors of a node on each face of ALL_FACES, null for the faces outside of the world
+        std::array<std::pair<ChunkState, const Chunk*>, ALL_FACES.size()> faces;
+        // bit I is set if the neighbors on ALL_FACES[I] are skipped (see prune)
+        uint8_t pruned = 0;
+        // the only neighbor is the x16 cube on this face, see expand
+        std::optional<Face> jump;
+    };
+
+    // the index of the axis of a face in ALL_FACES order: up/down, north/south, east/west
+    static constexpr int axis(Face face) {
+        return static_cast<int>(face) / 2;
+    }
 
-        PathNode* currentNode = openSet.removeLowest();
+    static constexpr Face opposite(Face face) {
+        return static_cast<Face>(static_cast<int>(face) ^ 1);
+    }
 
-        if (inGoal(currentNode->pos, goal.absolutePosCenter())) {
-            if (VERBOSE) {
-                std::cout << "chunkCache size = " << ctx.chunkCache.size() << '\n';
-                std::cout << "openSet size = " << openSet.getSize() << '\n';
-                std::cout << "map size = " << map.size() << '\n';
-                std::cout << '\n';
+    [[nodiscard]] double stepCost(ChunkState state) const {
+        return state == ChunkState::FROM_JAVA ? 1 : fakeChunkCost;
+    }
+
+    // Jump point search on the parts of the octree that are a grid of empty x16 cubes. A path through them can be
+    // reordered to make its moves on the earlier axes first (swapping two moves reaches the same cube, through another
+    // one), and it costs no more if that one costs no more than the cube it replaces. So when pos was reached from the
+    // x16 cube behind it, a neighbor on an earlier axis than that move is skipped if previous has an empty x16 cube that
+    // costs no more than pos on the same side: previous -> that cube -> the neighbor is as cheap and already in order.
+    // Everything else is forced: walls, smaller cubes and chunks that aren't loaded or cost more. Every swap sorts the
+    // path a bit more so each node keeps a cheapest path through the neighbors that are left, and an A* with a
+    // consistent heuristic returns the same cost with and without pruning.
+    // Ours isn't consistent and follows the goal almost greedily, it would only find the sorted paths by going back
+    // a lot. So the neighbors that are closer to the goal are never skipped. The search still expands the nodes in
+    // another order than without pruning and can end on a path that costs a bit more or less (694 vs 696 over the
+    // routes of BM_anytimeSearch), through open space like BM_symmetryPruning the cost is the same.
+    // The face towards previous is skipped too since the neighbor there is previous.
+    void prune(const NodePos& pos, const NodePos& previous, const BlockPos& target, const std::pair<ChunkState, const Chunk&>& currentChunk, NeighborChunks& chunks) {
+        if (pos.size() != Size::X16 || previous.size() != Size::X16) return;
+        const BlockPos bpos = pos.absolutePosZero();
+        const BlockPos from = previous.absolutePosZero();
+        const auto it = std::find_if(ALL_FACES.begin(), ALL_FACES.end(), [&](Face face) { return from.offset(face, 16) == bpos; });
+        if (it == ALL_FACES.end()) return;
+        const Face move = *it;
+        auto emptyX16 = [](const Chunk* chunk, const BlockPos& cube) {
+            const BlockPos local = cube.toChunkLocal();
+            return chunk && chunk->isEmpty<Size::X16>(local.x, local.y, local.z);
+        };
+        const double cost = stepCost(currentChunk.first);
+        chunks.pruned |= 1 << static_cast<int>(opposite(move));
+        const BlockPos center = pos.absolutePosCenter();
+        for (const Face face : ALL_FACES) {
+            if (axis(face) >= axis(move)) continue;
+            if (target.distanceToSq(center.offset(face, 16)) < target.distanceToSq(center)) continue;
+            if (!emptyX16(chunks.faces[static_cast<int>(face)].second, bpos.offset(face, 16))) continue;
+            const BlockPos beside = from.offset(face, 16);
+            std::pair<ChunkState, const Chunk*> besideChunk = chunks.faces[static_cast<int>(opposite(move))];
+            if (axis(face) != 0) {
+                // diagonal to pos, used if it's loaded already
+                const ChunkPos cpos = beside.toChunkPos();
+                const auto cached = ctx.chunkCache.find(cpos);
+                if (cached == ctx.chunkCache.end() || missingSections(ctx, cpos, cached->second.first, sectionMask(x16Index(beside.y), x16Index(beside.y)))) continue;
+                const auto [state, chunk] = getChunkOrAir(ctx, cpos, lazySections);
+                besideChunk = {state, &chunk};
+            }
+            if (emptyX16(besideChunk.second, beside) && stepCost(besideChunk.first) <= cost) {
+                chunks.pruned |= 1 << static_cast<int>(face);
             }
-            return createPath(map, startNode, currentNode, startCenter, goalCenter, Path::Type::FINISHED);
         }
-        const auto pos = currentNode->pos;
-        const auto size = pos.size;
+        // the moves on the last axis have no neighbors on later ones
+        if (axis(move) == 2 && std::popcount(chunks.pruned) == 5 && emptyX16(chunks.faces[static_cast<int>(move)].second, bpos.offset(move, 16))) {
+            chunks.jump = move;
+        }
+    }
+
+    // Generates and loads the chunks the neighbors of pos are in and finds them. previous is the node pos was reached
+    // from (null for the start or if it isn't known) and target where its side of the search goes, fakeChunkVisits is
+    // the number of fake chunks in a row of that side. Returns false if the search should give up.
+    // This is the only part of an expansion that modifies the chunk cache.
+    bool prepare(const NodePos& pos, const NodePos* previous, const BlockPos& target, int& fakeChunkVisits, NeighborChunks& chunks) {
+        const auto size = pos.size();
         const auto bpos = pos.absolutePosZero();
         const ChunkPos cpos = bpos.toChunkPos();
-        const std::pair currentChunk = getChunkOrAir(ctx, cpos);
-        if (currentChunk.first != ChunkState::FROM_JAVA) {
-            fakeChunkVisits++;
-        } else {
-            fakeChunkVisits = 0;
-        }
-        if (fakeChunkVisits >= 100 && airIfFake) {
-            return bestPathSoFar(map, startNode, bestSoFar, startCenter, goalCenter);
-        }
         const ChunkPos cposNorth = bpos.north(16).toChunkPos();
         const ChunkPos cposSouth = bpos.south(16).toChunkPos();
         const ChunkPos cposEast = bpos.east(16).toChunkPos();
         const ChunkPos cposWest = bpos.west(16).toChunkPos();
-        if (!airIfFake && !doneFull.contains(cpos)) {
-            ctx.topExecutor.compute(
-                    [&] {
-                        return getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executors[0], cposNorth, fakeChunkMode);
-                    },
-                    [&] {
-                        return getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executors[1], cposSouth, fakeChunkMode);
-                    },
-                    [&] {
-                        return getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executors[2], cposEast, fakeChunkMode);
-                    },
-                    [&] {
-                        return getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executors[3], cposWest, fakeChunkMode);
-                    }
-            );
-            doneFull.emplace(cpos, true);
-        }
-
-        auto callback = [&](const NodePos& neighborPos, const Chunk& chunk, ChunkState state) {
-            PathNode* neighborNode = getNodeAtPosition(map, neighborPos, goalCenter);
-            const double cost = state == ChunkState::FROM_JAVA ? 1 : fakeChunkCost;
-            const double tentativeCost = currentNode->cost + cost;
-            constexpr double MIN_IMPROVEMENT = 0.01;
-            if (neighborNode->cost - tentativeCost > MIN_IMPROVEMENT) {
-                neighborNode->previous = currentNode;
-                neighborNode->cost = tentativeCost;
-                neighborNode->combinedCost = tentativeCost + neighborNode->estimatedCostToGoal;
-
-                if (neighborNode->isOpen()) {
-                    openSet.update(neighborNode);
-                } else {
-                    openSet.insert(neighborNode);//dont double count, dont insert into open set if it's already there
+        // the neighbors of a node are at most one section above or below it
+        const int section = lazySections ? x16Index(bpos.y) : 0;
+        const int minSection = lazySections ? std::max(section - 1, 0) : 0;
+        const int maxSection = lazySections ? std::min(section + 1, GEN_SECTIONS - 1) : GEN_SECTIONS - 1;
+        if (!airIfFake && !doneFull.contains(BlockPos{cpos.x, section, cpos.z})) {
+            if (pregenerate) {
+                ctx.pregenerator.drain(ctx.chunkCache, *ctx.chunkAllocator, ctx.compressor);
+            }
+            // missing neighbors are generated with the rest of their tile, which usually also covers chunks the search will want soon
+            std::array<ChunkPos, 4> tiles;
+            int numTiles = 0;
+            for (const ChunkPos& neighbor : {cpos, cposNorth, cposSouth, cposEast, cposWest}) {
+                auto it = ctx.chunkCache.find(neighbor);
+                if (it != ctx.chunkCache.end() && !missingSections(ctx, neighbor, it->second.first, sectionMask(minSection, maxSection))) {
+                    ctx.compressor.touch(neighbor);
+                    continue;
                 }
-
-                const double heuristic = neighborNode->combinedCost;
-                if (bestHeuristicSoFar - heuristic > MIN_IMPROVEMENT) {
-                    bestHeuristicSoFar = heuristic;
-                    bestSoFar = neighborNode;
-
-                    if (failing &&
-                            startCenter.distanceToSq(neighborPos.absolutePosCenter()) > MIN_DIST_PATH * MIN_DIST_PATH) {
-                        failing = false;
-                    }
+                // the tile of cpos always has one of the east/west and one of the north/south neighbors so there are at most 3
+                static_assert(GEN_TILE_SIZE >= 2);
+                const ChunkPos tile = tileOf(neighbor);
+                if (std::find(tiles.begin(), tiles.begin() + numTiles, tile) == tiles.begin() + numTiles) {
+                    tiles[numTiles++] = tile;
                 }
             }
-        };
+            generateTiles(ctx, ctx.executor, std::span{tiles.data(), (size_t) numTiles}, minSection, maxSection);
+            doneFull.emplace(BlockPos{cpos.x, section, cpos.z}, true);
+        }
+        const std::pair currentChunk = getChunkOrAir(ctx, cpos, lazySections);
+        if (currentChunk.first != ChunkState::FROM_JAVA) {
+            fakeChunkVisits++;
+        } else {
+            fakeChunkVisits = 0;
+        }
+        if (fakeChunkVisits >= 100 && airIfFake) {
+            return false;
+        }
 
         [&]<size_t... I>(std::index_sequence<I...>) {
             ([&] {
@@ -408,56 +787,580 @@ std::optional<Path> findPathSegment(Context& ctx, const NodePos& start, const No
                 const NodePos neighborNodePos{size, bpos.offset(face, width(size))};
                 const BlockPos origin = neighborNodePos.absolutePosZero();
                 if constexpr (face == Face::UP || face == Face::DOWN) {
-                    if (!isInBounds(ctx.maxHeight, origin)) return;
+                    if (!isInBounds(ctx.maxHeight, origin)) {
+                        chunks.faces[I] = {ChunkState::FAKE, nullptr};
+                        return;
+                    }
                 }
                 const ChunkPos neighborCpos = origin.toChunkPos();
                 timeDoingIO += tryLoadRegionNative(ctx, neighborCpos);
                 const auto [state, chunk] =
                         face == Face::UP || face == Face::DOWN ? currentChunk :
-                        face == Face::NORTH ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposNorth) :
-                        face == Face::SOUTH ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposSouth) :
-                        face == Face::EAST ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposEast) :
-                        /* face == Face::WEST */ neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposWest);
+                        face == Face::NORTH ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposNorth, lazySections) :
+                        face == Face::SOUTH ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposSouth, lazySections) :
+                        face == Face::EAST ? neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposEast, lazySections) :
+                        /* face == Face::WEST */ neighborCpos == cpos ? currentChunk : getChunkOrAir(ctx, cposWest, lazySections);
+                chunks.faces[I] = {state, &chunk};
+            }(), ...);
+        }(std::make_index_sequence<ALL_FACES.size()>{});
+        if (symmetryPruning && previous) {
+            prune(pos, *previous, target, currentChunk, chunks);
+        }
+        return true;
+    }
+
+    // Calls callback(neighborPos, chunk, state) for every neighbor of pos, only reads the chunks
+    void forEachNeighbor(const NodePos& pos, const NeighborChunks& chunks, auto& callback) const {
+        const auto size = pos.size();
+        const auto bpos = pos.absolutePosZero();
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ([&] {
+                constexpr Face face = ALL_FACES[I];
+                const auto [state, chunk] = chunks.faces[I];
+                if (!chunk || (chunks.pruned >> I & 1)) return;
+                const NodePos neighborNodePos{size, bpos.offset(face, width(size))};
 
                 // 1x only
                 if (/*fine*/ false) {
-                    if (!chunk.isSolid(neighborNodePos.absolutePosZero())) {
-                        callback(neighborNodePos, chunk, state);
+                    if (!chunk->isSolid(neighborNodePos.absolutePosZero())) {
+                        callback(neighborNodePos, *chunk, state);
                     }
                 } else {
                     if (x4Min) {
-                        growThenIterateOuter<face, Size::X4>(chunk, state, neighborNodePos, callback);
+                        growThenIterateOuter<face, Size::X4>(*chunk, state, neighborNodePos, callback);
                     } else {
-                        growThenIterateOuter<face, Size::X2>(chunk, state, neighborNodePos, callback);
+                        growThenIterateOuter<face, Size::X2>(*chunk, state, neighborNodePos, callback);
                     }
                 }
             }(), ...);
         }(std::make_index_sequence<ALL_FACES.size()>{});
     }
 
-    auto[x, y, z] = bestSoFar->pos.absolutePosCenter();
+    static constexpr int MAX_JUMP = 16;
+
+    // Opens the neighbors of currentNode in side. other is the other direction of a bidirectional search (or null),
+    // every node of side that it has reached too is a path. Returns false if the search should give up.
+    // When pruning leaves a node with only the next cube in a straight line that one isn't opened, it's expanded right
+    // away (up to MAX_JUMP times) like the jumps of jump point search. It's as good as closed after that.
+    bool expand(SearchSide<OpenSet>& side, PathNode* currentNode, SearchSide<OpenSet>* other, bool forward) {
+        NeighborChunks chunks;
+        PathNode* jumpTo = nullptr;
+        auto callback = [&](const NodePos& neighborPos, const Chunk& chunk, ChunkState state) {
+            PathNode* neighborNode = side.nodeArena.getOrCreate(neighborPos, side.targetCenter);
+            const double tentativeCost = currentNode->cost + stepCost(state);
+            if (neighborNode->cost - tentativeCost > MIN_IMPROVEMENT) {
+                neighborNode->previous = currentNode->index;
+                neighborNode->cost = (float) tentativeCost;
+                neighborNode->combinedCost = (float) (tentativeCost + neighborNode->estimatedCostToGoal);
+
+                if (chunks.jump && !neighborNode->isOpen() && !inGoal(neighborPos, side.targetCenter)) {
+                    jumpTo = neighborNode;
+                } else if (neighborNode->isOpen()) {
+                    side.openSet.update(neighborNode);
+                } else {
+                    side.openSet.insert(neighborNode);//dont double count, dont insert into open set if it's already there
+                }
+                if (other && neighborNode->isOpen()) {
+                    side.bounds.push({tentativeCost + hopLowerBound(neighborPos, side.targetCenter, minStepCost), neighborNode->cost, neighborNode->index});
+                }
+
+                const double heuristic = neighborNode->combinedCost;
+                if (side.bestHeuristicSoFar - heuristic > MIN_IMPROVEMENT) {
+                    side.bestHeuristicSoFar = heuristic;
+                    side.bestSoFar = neighborNode;
+
+                    if (side.failing &&
+                            side.startCenter.distanceToSq(neighborPos.absolutePosCenter()) > MIN_DIST_PATH * MIN_DIST_PATH) {
+                        side.failing = false;
+                    }
+                }
+
+                if (other) {
+                    // the sides rarely pick the same cube in the same place, any node of the other side that
+                    // contains the center of this one connects them
+                    const BlockPos center = neighborPos.absolutePosCenter();
+                    for (const Size otherSize : {Size::X1, Size::X2, Size::X4, Size::X8, Size::X16}) {
+                        PathNode* otherNode = other->nodeArena.find(NodePos{otherSize, center});
+                        if (otherNode && neighborNode->cost + otherNode->cost < meetCost - MIN_IMPROVEMENT) {
+                            meetCost = neighborNode->cost + otherNode->cost;
+                            forwardMeet = forward ? neighborNode : otherNode;
+                            backwardMeet = forward ? otherNode : neighborNode;
+                        }
+                    }
+                }
+            }
+        };
+        for (int jumps = 0; ; jumps++) {
+            chunks = {};
+            const NodePos* previous = currentNode->previous != PathNode::NONE ? &side.nodeArena[currentNode->previous].pos : nullptr;
+            if (!prepare(currentNode->pos, previous, side.targetCenter, side.fakeChunkVisits, chunks)) {
+                return false;
+            }
+            if (jumps == MAX_JUMP) chunks.jump.reset();
+            jumpTo = nullptr;
+            forEachNeighbor(currentNode->pos, chunks, callback);
+            if (!jumpTo) break;
+            currentNode = jumpTo;
+        }
+
+        if (pregenerate) {
+            const BlockPos bestPos = side.bestSoFar->pos.absolutePosCenter();
+            if (const ChunkPos tile = tileOf(bestPos.toChunkPos()); tile != side.frontierTile) {
+                side.frontierTile = tile;
+                requestCorridor(ctx, bestPos, side.targetCenter, PREGEN_FRONTIER_TILES, true);
+            }
+        }
+        return true;
+    }
+};
+
+// What every search does before its loop: the compressed chunks are synced, the chunks of the start (and of the goal
+// with loadGoal) are loaded and the pregenerator gets the corridor between them. Whatever it still has queued when the
+// search returns won't be needed and is cancelled. The timeouts start once that's done.
+struct SearchScope {
+    ChunkPregenerator& pregenerator;
+    std::chrono::system_clock::time_point primaryTimeoutTime;
+    std::chrono::system_clock::time_point failureTimeout;
+
+    SearchScope(Context& ctx, const NodePos& start, const NodePos& goal, bool loadGoal, bool airIfFake, bool pregenerate, int timeoutMs):
+        pregenerator(ctx.pregenerator)
+    {
+        const auto fakeChunkMode = airIfFake ? FakeChunkMode::AIR : FakeChunkMode::GENERATE;
+        {
+            // getChunk from Java can run at the same time
+            std::lock_guard lock(ctx.cacheMutex);
+            ctx.compressor.sync(ctx.chunkCache, *ctx.chunkAllocator);
+        }
+        auto load = [&](const NodePos& pos) {
+            tryLoadRegionNative(ctx, pos.absolutePosZero().toChunkPos());
+            getRealChunkFromCacheOrFakeChunkMaybeGen(ctx, ctx.executor, pos.absolutePosZero().toChunkPos(), fakeChunkMode);
+        };
+        load(start);
+        if (loadGoal) load(goal);
+        if (pregenerate) {
+            requestCorridor(ctx, start.absolutePosCenter(), goal.absolutePosCenter(), PREGEN_CORRIDOR_TILES, false);
+        }
+
+        using namespace std::chrono_literals;
+        const auto startTime = std::chrono::system_clock::now();
+        this->primaryTimeoutTime = startTime + 500ms;
+        this->failureTimeout = startTime + (timeoutMs != 0 ? std::chrono::milliseconds{timeoutMs} : 30s);
+    }
+
+    SearchScope(const SearchScope&) = delete;
+
+    ~SearchScope() {
+        this->pregenerator.cancel();
+    }
+
+    // The time spent loading regions doesn't count. The primary timeout only counts once the search has something
+    // worth returning.
+    [[nodiscard]] bool timedOut(std::chrono::milliseconds timeDoingIO, bool hasPath) const {
+        const auto now = std::chrono::system_clock::now() - timeDoingIO;
+        return now >= this->failureTimeout || (hasPath && now >= this->primaryTimeoutTime);
+    }
+};
+
+// Searches from the start and from the goal at the same time, on the calling thread because both sides generate and
+// insert chunks. Each step expands the cheapest node of the side with the smaller open set and every node reached by
+// both is a path. The heuristic is in blocks and the costs are in steps, so it can't tell when the best of those paths
+// is the cheapest: that's once the open nodes of a side all have a cost + hopLowerBound that is at least its cost
+// (a cheaper path would go through one of them). A side that gets to its goal has found a path like those.
+// At the timeout it returns the best of those paths if there is one, the best segment of the forward side otherwise
+// (the backward one doesn't start at the start).
+// The goal side uses the same neighbors: two air cubes that share a face can be walked between both ways.
+template<typename OpenSet>
+std::optional<Path> findPathBidirectional(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    const auto goalCenter = goal.absolutePosCenter();
+    const auto startCenter = start.absolutePosCenter();
+
+    Search<OpenSet> search{ctx, x4Min, airIfFake, fakeChunkCost};
+    SearchSide<OpenSet> forward{start, goal};
+    SearchSide<OpenSet> backward{goal, start};
+    for (SearchSide<OpenSet>* side : {&forward, &backward}) {
+        side->bounds.push({hopLowerBound(side->startNode->pos, side->targetCenter, search.minStepCost), 0, side->startNode->index});
+    }
+    const SearchScope scope{ctx, start, goal, true, airIfFake, search.pregenerate, timeoutMs};
+
+    int numNodes = 0;
+    // if either side runs out of nodes they can't meet, for the backward side that means the goal is closed off
+    while (!forward.openSet.isEmpty() && !backward.openSet.isEmpty()) {
+        constexpr int timeCheckInterval = 1 << 6;
+        if ((numNodes++ & (timeCheckInterval - 1)) == 0) {
+            if (scope.timedOut(search.timeDoingIO, !forward.failing)) {
+                break;
+            } else if (ctx.cancelFlag.test()) {
+                return {};
+            }
+        }
+
+        if (search.forwardMeet && std::max(forward.lowestBound(), backward.lowestBound()) >= search.meetCost - MIN_IMPROVEMENT) {
+            break;
+        }
+        // the side with fewer open nodes goes (Pohl's cardinality rule), it's the one that is cheaper to grow
+        const bool forwardTurn = forward.openSet.getSize() <= backward.openSet.getSize();
+        SearchSide<OpenSet>& side = forwardTurn ? forward : backward;
+        PathNode* currentNode = side.openSet.removeLowest();
+
+        if (inGoal(currentNode->pos, side.targetCenter)) {
+            // a path on its own, which isn't always the cheapest one either
+            if (currentNode->cost < search.meetCost - MIN_IMPROVEMENT) {
+                search.meetCost = currentNode->cost;
+                search.forwardMeet = forwardTurn ? currentNode : forward.startNode;
+                search.backwardMeet = forwardTurn ? nullptr : currentNode;
+            }
+            continue;
+        }
+        if (!search.expand(side, currentNode, forwardTurn ? &backward : &forward, forwardTurn)) {
+            break;
+        }
+    }
+
+    if (VERBOSE) {
+        std::cout << "PathNode count: " << forward.nodeArena.size() << " + " << backward.nodeArena.size() << '\n';
+    }
+    if (search.forwardMeet && !search.backwardMeet) {
+        return createPath(forward.nodeArena, forward.startNode, search.forwardMeet, startCenter, goalCenter, Path::Type::FINISHED);
+    }
+    if (search.forwardMeet) {
+        return createPath(forward.nodeArena, search.forwardMeet, backward.nodeArena, search.backwardMeet, startCenter, goalCenter, Path::Type::FINISHED);
+    }
+    return bestPathSoFar(forward.nodeArena, forward.startNode, forward.bestSoFar, startCenter, goalCenter);
+}
+
+// the weights of the anytime search, it stops lowering them once it gets to 1
+constexpr std::array ANYTIME_WEIGHTS{16.0, 8.0, 4.0, 2.0, 1.5, 1.2, 1.0};
+
+// Anytime repairing A* (ARA*), see Context::anytimeSearch. The heuristic of the other searches overestimates a lot,
+// this one is a lower bound of the cost to the goal (a step goes at most 16 blocks between the centers of two cubes)
+// which is multiplied by a weight. A search with weight w finds a path that costs at most w times the cheapest one.
+// The first weight is about as greedy as the normal search. Each time a path is found the weight goes down and the
+// search goes on with the same nodes: the open ones and the ones that got cheaper after they were expanded with the
+// old weight are queued again with the new one, nothing else is expanded again.
+// It returns the last path it found when the weight is 1 or the path is known to be the cheapest, or at the same
+// 500 ms the normal search stops at. Without one it times out and returns the best segment like the normal search.
+template<typename OpenSet>
+std::optional<Path> findPathAnytime(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    const auto goalCenter = goal.absolutePosCenter();
+    const auto startCenter = start.absolutePosCenter();
+
+    Search<OpenSet> search{ctx, x4Min, airIfFake, fakeChunkCost};
+    SearchSide<OpenSet> forward{start, goal};
+    const SearchScope scope{ctx, start, goal, false, airIfFake, search.pregenerate, timeoutMs};
+
+    auto lowerBound = [&](const NodePos& pos) {
+        return hopLowerBound(pos, goalCenter, search.minStepCost);
+    };
+    size_t weightIndex = 0;
+    double weight = ANYTIME_WEIGHTS[weightIndex];
+    // the keys are relative to the start's like PathNode::estimatedCostToGoal
+    const double startBound = lowerBound(start);
+    auto key = [&](const PathNode* node) {
+        return (float) (node->cost + weight * (lowerBound(node->pos) - startBound));
+    };
+    // the weight a node was last expanded with (its index + 1, 0 if it wasn't)
+    std::vector<uint8_t> expandedWith;
+    // the nodes that got cheaper after they were expanded with this weight, a node can be in it more than once
+    std::vector<PathNode*> incons;
+    auto isExpanded = [&](const PathNode* node) {
+        return node->index < expandedWith.size() && expandedWith[node->index] == weightIndex + 1;
+    };
+    std::optional<Path> found;
+    PathNode* goalNode = nullptr;
+    int numNodes = 0;
+    for (;;) {
+        // expands the nodes that can lead to a path that costs less than goalNode with this weight
+        bool timedOut = false;
+        while (!forward.openSet.isEmpty()) {
+            constexpr int timeCheckInterval = 1 << 6;
+            if ((numNodes++ & (timeCheckInterval - 1)) == 0) {
+                if (scope.timedOut(search.timeDoingIO, found || !forward.failing)) {
+                    timedOut = true;
+                    break;
+                } else if (ctx.cancelFlag.test()) {
+                    return {};
+                }
+            }
+
+            PathNode* currentNode = forward.openSet.removeLowest();
+            if (goalNode && currentNode->combinedCost >= goalNode->cost - weight * startBound) {
+                forward.openSet.insert(currentNode);
+                break;
+            }
+            if (inGoal(currentNode->pos, goalCenter)) {
+                if (!goalNode || currentNode->cost < goalNode->cost) goalNode = currentNode;
+                continue;
+            }
+            if (expandedWith.size() <= currentNode->index) expandedWith.resize(forward.nodeArena.size());
+            expandedWith[currentNode->index] = weightIndex + 1;
+
+            typename Search<OpenSet>::NeighborChunks chunks;
+            const NodePos* previous = currentNode->previous != PathNode::NONE ? &forward.nodeArena[currentNode->previous].pos : nullptr;
+            if (!search.prepare(currentNode->pos, previous, goalCenter, forward.fakeChunkVisits, chunks)) {
+                timedOut = true;
+                break;
+            }
+            auto callback = [&](const NodePos& neighborPos, const Chunk&, ChunkState state) {
+                PathNode* neighborNode = forward.nodeArena.getOrCreate(neighborPos, goalCenter);
+                const double tentativeCost = currentNode->cost + search.stepCost(state);
+                if (neighborNode->cost - tentativeCost <= MIN_IMPROVEMENT) return;
+                neighborNode->previous = currentNode->index;
+                neighborNode->cost = (float) tentativeCost;
+                if (isExpanded(neighborNode)) {
+                    incons.push_back(neighborNode);
+                    return;
+                }
+                neighborNode->combinedCost = key(neighborNode);
+                if (neighborNode->isOpen()) {
+                    forward.openSet.update(neighborNode);
+                } else {
+                    forward.openSet.insert(neighborNode);
+                }
+                const double heuristic = tentativeCost + neighborNode->estimatedCostToGoal;
+                if (forward.bestHeuristicSoFar - heuristic > MIN_IMPROVEMENT) {
+                    forward.bestHeuristicSoFar = heuristic;
+                    forward.bestSoFar = neighborNode;
+                    if (forward.failing && startCenter.distanceToSq(neighborPos.absolutePosCenter()) > MIN_DIST_PATH * MIN_DIST_PATH) {
+                        forward.failing = false;
+                    }
+                }
+            };
+            search.forEachNeighbor(currentNode->pos, chunks, callback);
+
+            if (search.pregenerate) {
+                const BlockPos bestPos = forward.bestSoFar->pos.absolutePosCenter();
+                if (const ChunkPos tile = tileOf(bestPos.toChunkPos()); tile != forward.frontierTile) {
+                    forward.frontierTile = tile;
+                    requestCorridor(ctx, bestPos, goalCenter, PREGEN_FRONTIER_TILES, true);
+                }
+            }
+        }
+
+        // the open nodes and incons with the next weight, what the cheapest path can cost at least comes with it
+        std::vector<PathNode*> queued;
+        while (!forward.openSet.isEmpty()) {
+            queued.push_back(forward.openSet.removeLowest());
+        }
+        double cheapest = PathNode::COST_INF;
+        for (PathNode* node : queued) {
+            cheapest = std::min(cheapest, node->cost + lowerBound(node->pos));
+        }
+        for (PathNode* node : incons) {
+            cheapest = std::min(cheapest, node->cost + lowerBound(node->pos));
+        }
+
+        if (goalNode) {
+            // finishing a weight proves it even if the nodes that are left could lead to something cheaper
+            double bound = std::max(1.0, goalNode->cost / cheapest);
+            if (!timedOut) bound = std::min(bound, weight);
+            if (!found || found->nodes.back().cost - goalNode->cost > MIN_IMPROVEMENT) {
+                found = createPath(forward.nodeArena, forward.startNode, goalNode, startCenter, goalCenter, Path::Type::FINISHED);
+                found->bound = bound;
+                if (VERBOSE) std::cout << "anytime path cost " << goalNode->cost << " bound " << bound << '\n';
+                if (ctx.anytimeProgress) ctx.anytimeProgress(*found);
+            } else {
+                found->bound = std::min(found->bound, bound);
+            }
+        }
+        // without a goal the open set ran out (there is no path) or the time did
+        if (!goalNode || timedOut || weightIndex + 1 == ANYTIME_WEIGHTS.size() || found->bound <= 1) break;
+
+        weight = ANYTIME_WEIGHTS[++weightIndex];
+        for (PathNode* node : incons) {
+            if (!node->isOpen()) queued.push_back(node);
+        }
+        incons.clear();
+        for (PathNode* node : queued) {
+            node->combinedCost = key(node);
+            forward.openSet.insert(node);
+        }
+    }
+    if (found) return found;
+    return bestPathSoFar(forward.nodeArena, forward.startNode, forward.bestSoFar, startCenter, goalCenter);
+}
+
+template<typename OpenSet>
+std::optional<Path> findPathSegment0(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    if (ctx.anytimeSearch) {
+        return findPathAnytime<OpenSet>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+    }
+    if (ctx.bidirectional) {
+        return findPathBidirectional<OpenSet>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+    }
+    const auto goalCenter = goal.absolutePosCenter();
+    const auto startCenter = start.absolutePosCenter();
+    if (VERBOSE) std::cout << "distance = " << start.absolutePosCenter().distanceTo(goalCenter) << '\n';
+
+    Search<OpenSet> search{ctx, x4Min, airIfFake, fakeChunkCost};
+    SearchSide<OpenSet> forward{start, goal};
+    const SearchScope scope{ctx, start, goal, false, airIfFake, search.pregenerate, timeoutMs};
+
+    int numNodes = 0;
+    while (!forward.openSet.isEmpty()) {
+        constexpr int timeCheckInterval = 1 << 6;
+        if ((numNodes & (timeCheckInterval - 1)) == 0) { // only call this once every 64 nodes
+            if (scope.timedOut(search.timeDoingIO, !forward.failing)) {
+                break;
+            } else if (ctx.cancelFlag.test()) {
+                return {};
+            }
+        }
+
+        PathNode* currentNode = forward.openSet.removeLowest();
+
+        if (inGoal(currentNode->pos, goal.absolutePosCenter())) {
+            if (VERBOSE) {
+                std::cout << "chunkCache size = " << ctx.chunkCache.size() << '\n';
+                std::cout << "openSet size = " << forward.openSet.getSize() << '\n';
+                std::cout << "node count = " << forward.nodeArena.size() << '\n';
+                std::cout << '\n';
+            }
+            return createPath(forward.nodeArena, forward.startNode, currentNode, startCenter, goalCenter, Path::Type::FINISHED);
+        }
+        if (!search.expand(forward, currentNode, nullptr, true)) {
+            return bestPathSoFar(forward.nodeArena, forward.startNode, forward.bestSoFar, startCenter, goalCenter);
+        }
+    }
+
+    auto[x, y, z] = forward.bestSoFar->pos.absolutePosCenter();
     if (VERBOSE) {
         std::cout << "Best position = {" << x << ", " << y << ", " << z << "}\n";
-        std::cout << "failing = " << failing << '\n';
-        std::cout << "Open set width: " << openSet.getSize() << '\n';
-        std::cout << "PathNode map size: " << map.size() << '\n';
+        std::cout << "failing = " << forward.failing << '\n';
+        std::cout << "Open set width: " << forward.openSet.getSize() << '\n';
+        std::cout << "PathNode count: " << forward.nodeArena.size() << '\n';
         std::cout << "chunk cache size: " << ctx.chunkCache.size() << '\n';
         std::cout << '\n';
     }
-    return bestPathSoFar(map, startNode, bestSoFar, startCenter, goalCenter);
+    return bestPathSoFar(forward.nodeArena, forward.startNode, forward.bestSoFar, startCenter, goalCenter);
+}
+
+// findPathSegment without Context::incrementalReplanning
+std::optional<Path> findPathFromScratch(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    switch (ctx.openSet) {
+        case OpenSetType::BINARY_HEAP_POINTERS:
+            return findPathSegment0<BinaryHeapOpenSet>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+        case OpenSetType::BINARY_HEAP:
+            return findPathSegment0<HeapOpenSet<2>>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+        case OpenSetType::QUATERNARY_HEAP:
+            return findPathSegment0<HeapOpenSet<4>>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+        case OpenSetType::BUCKETS:
+            return findPathSegment0<BucketOpenSet>(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+    }
+    throw std::range_error("bad open set type");
+}
+
+// Sees the world through the chunk cache like the normal search, which finds the neighbors
+struct IncrementalWorld : IncrementalSearch::World {
+    Context& ctx;
+    Search<HeapOpenSet<4>> search;
+    const BlockPos startCenter;
+    const std::chrono::system_clock::time_point failureTimeout;
+    bool cancelled = false;
+
+    IncrementalWorld(Context& ctx, const NodePos& start, bool x4Min, bool airIfFake, double fakeChunkCost, std::chrono::system_clock::time_point failureTimeout):
+        ctx(ctx), search(ctx, x4Min, airIfFake, fakeChunkCost), startCenter(start.absolutePosCenter()), failureTimeout(failureTimeout) {}
+
+    std::optional<float> stepCost(const NodePos& pos) override {
+        const BlockPos bpos = pos.absolutePosZero();
+        if (!isInBounds(ctx.maxHeight, bpos)) return std::nullopt;
+        const ChunkPos cpos = bpos.toChunkPos();
+        search.timeDoingIO += tryLoadRegionNative(ctx, cpos);
+        if (!search.airIfFake) {
+            getOrGenChunk(ctx, ctx.executor, cpos);
+        }
+        const auto [state, chunk] = getChunkOrAir(ctx, cpos, false);
+        const BlockPos local = bpos.toChunkLocal();
+        bool empty = false;
+        switch (pos.size()) {
+            case Size::X1: empty = chunk.isEmpty<Size::X1>(local.x, local.y, local.z); break;
+            case Size::X2: empty = chunk.isEmpty<Size::X2>(local.x, local.y, local.z); break;
+            case Size::X4: empty = chunk.isEmpty<Size::X4>(local.x, local.y, local.z); break;
+            case Size::X8: empty = chunk.isEmpty<Size::X8>(local.x, local.y, local.z); break;
+            case Size::X16: empty = chunk.isEmpty<Size::X16>(local.x, local.y, local.z); break;
+        }
+        if (!empty) return std::nullopt;
+        return (float) search.stepCost(state);
+    }
+
+    bool neighbors(const NodePos& pos, std::vector<std::pair<NodePos, float>>& out) override {
+        // the nodes aren't expanded along a path so fake chunks in a row mean nothing here
+        int fakeChunkVisits = 0;
+        Search<HeapOpenSet<4>>::NeighborChunks chunks;
+        if (!search.prepare(pos, nullptr, startCenter, fakeChunkVisits, chunks)) return false;
+        auto callback = [&](const NodePos& neighborPos, const Chunk&, ChunkState state) {
+            out.emplace_back(neighborPos, (float) search.stepCost(state));
+        };
+        search.forEachNeighbor(pos, chunks, callback);
+        return true;
+    }
+
+    bool expired() override {
+        if (ctx.cancelFlag.test()) {
+            cancelled = true;
+            return true;
+        }
+        return std::chrono::system_clock::now() - search.timeDoingIO >= failureTimeout;
+    }
+};
+
+// Context::incrementalReplanning: D* Lite with the nodes of the last plan to the same goal (see IncrementalSearch). The
+// path is always to the goal, if there is none or the search runs out of time it falls back to findPathFromScratch
+// with what is left of timeoutMs (its own budget if that was 0).
+std::optional<Path> findPathIncremental(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    using namespace std::chrono_literals;
+    const auto startTime = std::chrono::system_clock::now();
+    const auto timeout = timeoutMs != 0 ? std::chrono::milliseconds{timeoutMs} : 30s;
+
+    {
+        std::lock_guard lock(ctx.cacheMutex);
+        ctx.compressor.sync(ctx.chunkCache, *ctx.chunkAllocator);
+    }
+    IncrementalWorld world{ctx, start, x4Min, airIfFake, fakeChunkCost, startTime + timeout};
+    std::vector<std::pair<NodePos, double>> steps;
+    const auto result = ctx.incrementalSearch.plan(start, goal, {x4Min, airIfFake, fakeChunkCost}, world, steps);
+    if (world.cancelled) return {};
+    if (result != IncrementalSearch::Result::FOUND) {
+        if (VERBOSE) std::cout << "incremental search " << (result == IncrementalSearch::Result::NO_PATH ? "found no path" : "gave up") << '\n';
+        int remainingMs = 0;
+        if (timeoutMs != 0) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime);
+            remainingMs = (int) std::max<int64_t>(timeout.count() - elapsed.count(), 1);
+        }
+        return findPathFromScratch(ctx, start, goal, x4Min, remainingMs, airIfFake, fakeChunkCost);
+    }
+
+    const BlockPos goalCenter = goal.absolutePosCenter();
+    const double total = steps.front().second;
+    const double heuristicOrigin = PathNode::heuristic(start, goalCenter);
+    std::vector<PathNode> nodes;
+    nodes.reserve(steps.size());
+    for (const auto& [pos, remaining] : steps) {
+        PathNode& node = nodes.emplace_back(pos, goalCenter, heuristicOrigin, (uint32_t) nodes.size());
+        node.cost = (float) (total - remaining);
+        node.combinedCost = node.cost + node.estimatedCostToGoal;
+        node.previous = nodes.size() > 1 ? node.index - 1 : PathNode::NONE;
+    }
+    return createPath(std::move(nodes), start.absolutePosCenter(), goalCenter, Path::Type::FINISHED);
+}
+
+std::optional<Path> findPathSegment(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int timeoutMs, bool airIfFake, double fakeChunkCost) {
+    if (ctx.incrementalReplanning) {
+        return findPathIncremental(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
+    }
+    return findPathFromScratch(ctx, start, goal, x4Min, timeoutMs, airIfFake, fakeChunkCost);
 }
 
 // TODO: fix this lol
-const Chunk& getChunkNoMutex(const BlockPos& pos, const ChunkGeneratorHell& gen, ChunkGenExec& exec, cache_t& cache, Allocator<Chunk>& allocator) {
+const Chunk& getChunkNoMutex(Context& ctx, const BlockPos& pos) {
     const ChunkPos chunkPos = pos.toChunkPos();
-    auto it = cache.find(chunkPos);
-    if (it != cache.end()) {
-        return *it->second.second;
+    auto it = ctx.chunkCache.find(chunkPos);
+    if (it != ctx.chunkCache.end()) {
+        return uncompressedChunk(ctx, chunkPos, it->second);
     } else {
-        Chunk* ptr = allocator.allocate();
+        Chunk* ptr = ctx.chunkAllocator->allocate();
         auto& chunk = *ptr;
-        gen.generateChunk(chunkPos.x, chunkPos.z, *ptr, exec);
-        cache.emplace(chunkPos, std::pair{ChunkState::FAKE, ptr});
+        ctx.generator.generateChunk(chunkPos.x, chunkPos.z, *ptr, ctx.executor);
+        ctx.chunkCache.emplace(chunkPos, std::pair{ChunkState::FAKE, ptr});
         return chunk;
     }
 }
@@ -476,7 +1379,7 @@ NodePos findAir(Context& ctx, const BlockPos& start1x) {
         const auto blockPos = node.absolutePosZero();
         queue.pop();
         if (isInBounds(ctx.maxHeight, node.absolutePosZero())) {
-            const auto& chunk = getChunkNoMutex(blockPos, ctx.generator, ctx.executors[0], ctx.chunkCache, *ctx.chunkAllocator);
+            const auto& chunk = getChunkNoMutex(ctx, blockPos);
             if (chunk.isEmpty<size>(blockPos.x & 15, blockPos.y, blockPos.z & 15)) {
                 return node;
             }
@@ -504,8 +1407,8 @@ template NodePos findAir<Size::X4>(Context& ctx, const BlockPos& start1x);
 
 void appendPath(Path& path, Path&& segment) {
     path.blocks.insert(path.blocks.end(), segment.blocks.begin(), segment.blocks.end());
-    path.nodes.insert(path.nodes.end(), std::move_iterator{segment.nodes.begin()},
-                      std::move_iterator{segment.nodes.end()});
+    // not insert, the const members of PathNode only allow constructing them
+    std::copy(segment.nodes.begin(), segment.nodes.end(), std::back_inserter(path.nodes));
 }
 
 Path splicePaths(std::vector<Path>&& paths) {
@@ -527,21 +1430,27 @@ std::optional<Path> findPathFull(Context& ctx, const NodePos& start, const NodeP
         const NodePos lastPathEnd = !segments.empty() ? NodePos{Size::X2, segments.back().getEndPos()} : start;
         std::optional path = findPathSegment(ctx, lastPathEnd, goal, true, 0, false, fakeChunkCost);
         if (!path.has_value()) {
-            if (cancelFlag.test()) {
-                cancelFlag.clear();
+            if (ctx.cancelFlag.test()) {
+                ctx.cancelFlag.clear();
                 return std::nullopt;
             } else {
                 break;
             }
         } else {
             const bool finished = path->type == Path::Type::FINISHED;
-            auto endCpos = path->blocks.end()->toChunkPos();
+            auto endCpos = path->getEndPos().toChunkPos();
             const auto distSqBlocks = (200 / 16) * (200 / 16);
             const auto distSq = distSqBlocks;
+            ctx.compressor.cancelPending();
             std::erase_if(ctx.chunkCache, [&](const auto& item) {
                 const auto cpos = item.first;
                 bool out = cpos.distanceToSq({endCpos.x, endCpos.z}) > distSq;
-                if (out) ctx.chunkAllocator->free(item.second.second);
+                if (out) {
+                    ctx.compressor.remove(cpos);
+                    ctx.partialSections.erase(cpos);
+                    ctx.incrementalSearch.chunkChanged(cpos);
+                    if (item.second.second) ctx.chunkAllocator->free(item.second.second);
+                }
                 return out;
             });
 
@@ -3,6 +3,7 @@
 #include <vector>
 #include <optional>
 #include <unordered_set>
+#include <functional>
 
 #include <jni.h>
 
@@ -11,6 +12,9 @@
 #include "PathNode.h"
 #include "ChunkGen.h"
 #include "Allocator.h"
+#include "ChunkCompressor.h"
+#include "ChunkPregenerator.h"
+#include "IncrementalSearch.h"
 
 enum class FakeChunkMode {
     GENERATE = 0
@@ -18,6 +22,18 @@ enum class FakeChunkMode {
     ,SOLID = 2
 };
 
+// The priority queue of the search, see the headers of the implementations. The ids are used by the java api.
+enum class OpenSetType {
+    // BinaryHeapOpenSet, which compares the costs in the nodes
+    BINARY_HEAP_POINTERS = 0
+    // HeapOpenSet<2>, same order as BINARY_HEAP_POINTERS
+    ,BINARY_HEAP = 1
+    // HeapOpenSet<4>
+    ,QUATERNARY_HEAP = 2
+    // BucketOpenSet, only orders the nodes to 1/8 of a cost
+    ,BUCKETS = 3
+};
+
 struct Path {
     enum class Type {
         SEGMENT,
@@ -28,8 +44,11 @@ struct Path {
     BlockPos start;
     BlockPos goal; // where the path wants to go, not necessarily where it ends
     std::vector<BlockPos> blocks;
-    std::vector<std::unique_ptr<PathNode>> nodes;
+    // copies of the nodes of the search, their indices (and previous) mean nothing once it's over
+    std::vector<PathNode> nodes;
     cache_t chunkCache;
+    // the path costs at most this many times as much as the cheapest one, 0 if the search doesn't know (see findPathAnytime)
+    double bound = 0;
 
     [[nodiscard]] const BlockPos& getEndPos() const {
         // This should basically never be empty
@@ -43,16 +62,46 @@ struct Context {
     std::mutex cacheMutex;
     std::unique_ptr<Allocator<Chunk>> chunkAllocator;
     cache_t chunkCache;
-    ParallelExecutor<4> topExecutor;
-    std::array<ChunkGenExec, 4> executors;
+    // The generated x16 sections (bit s is section s) of the PARTIAL chunks in the cache, guarded by cacheMutex too.
+    // An entry means nothing once its chunk stops being PARTIAL.
+    map_t<ChunkPos, uint8_t> partialSections;
+    // The search only generates the sections around the nodes it expands, the rest of a chunk is generated when something else uses it.
+    bool lazySections = false;
+    OpenSetType openSet = OpenSetType::BINARY_HEAP_POINTERS;
+    // findPathSegment searches from the goal too, see findPathBidirectional
+    bool bidirectional = false;
+    // findPathSegment skips some neighbors of empty x16 cubes and jumps through open space, see Search::prune.
+    // The paths can cost slightly more or less than without it.
+    bool symmetryPruning = false;
+    // findPathSegment lowers the weight of its heuristic and improves the path until the time is up, see findPathAnytime.
+    // bidirectional is ignored with it.
+    bool anytimeSearch = false;
+    // called with every path the anytime search finds (each one is cheaper than the last), the last one is returned
+    std::function<void(const Path&)> anytimeProgress;
+    ChunkCompressor compressor;
+    ChunkPregenerator pregenerator;
+    // findPathSegment repairs the last search to the same goal instead of starting over (see findPathIncremental),
+    // incrementalSearch has to be told when a chunk in the cache changes too
+    bool incrementalReplanning = false;
+    IncrementalSearch incrementalSearch;
+    // every executor of this context runs on this pool (TaskPool::shared() unless the context was made with its own)
+    std::shared_ptr<TaskPool> taskPool;
+    ChunkGenExec executor;
     std::atomic_flag cancelFlag;
+    // progress of the running pregenerateRegion, it can be read by other threads while that runs
+    std::atomic_uint64_t regionChunksDone{};
+    std::atomic_uint64_t regionChunksTotal{};
     std::unordered_set<RegionPos> checkedRegions;
     int maxHeight;
     Dimension dimension;
 
 
-    explicit Context(int64_t seed, std::optional<std::string>&& cacheDir, Dimension dim, int maxHeight, bool pageAllocator):
-        generator(ChunkGeneratorHell::fromSeed(seed)), baritoneCache(cacheDir), maxHeight(maxHeight), dimension(dim)
+    // threads >= 0 gives the context its own pool with that many workers, otherwise it uses the shared one
+    explicit Context(int64_t seed, std::optional<std::string>&& cacheDir, Dimension dim, int maxHeight, bool pageAllocator, int threads = -1):
+        generator(ChunkGeneratorHell::fromSeed(seed)), baritoneCache(cacheDir), pregenerator(generator),
+        taskPool(threads < 0 ? TaskPool::shared() : std::make_shared<TaskPool>(threads)),
+        executor(taskPool),
+        maxHeight(maxHeight), dimension(dim)
         {
             if (maxHeight <= 0 || maxHeight > 384) {
                 throw std::range_error("bad max height");
@@ -63,9 +112,11 @@ struct Context {
                 chunkAllocator = std::make_unique<Allocator<Chunk>>();
             }
         }
-    explicit Context(int64_t seed, Dimension dim, int maxHeight, bool pageAllocator): Context(seed, std::nullopt, dim, maxHeight, pageAllocator) {}
-    explicit Context(int64_t seed, std::string&& cacheDir, Dimension dim, int maxHeight, bool pageAllocator): Context(seed, std::optional{cacheDir}, dim, maxHeight, pageAllocator) {}
+    explicit Context(int64_t seed, Dimension dim, int maxHeight, bool pageAllocator, int threads = -1): Context(seed, std::nullopt, dim, maxHeight, pageAllocator, threads) {}
+    explicit Context(int64_t seed, std::string&& cacheDir, Dimension dim, int maxHeight, bool pageAllocator, int threads = -1): Context(seed, std::optional{cacheDir}, dim, maxHeight, pageAllocator, threads) {}
     ~Context() {
+        pregenerator.stop();
+        compressor.stop();
         // useless optimization
         if (!chunkAllocator->auto_frees_on_destroy()) {
             for (auto &p: chunkCache) {
@@ -82,7 +133,16 @@ struct Context {
 const Chunk& getRealChunkFromCacheOrFakeChunkMaybeGen(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos, FakeChunkMode mode);
 // gets from cache, or generates and inserts into cache
 const Chunk& getOrGenChunk(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos);
+// generates the sections [minSection, maxSection] of every chunk in the tile that contains pos that doesn't have them yet
+void generateTile(Context& ctx, ChunkGenExec& executor, const ChunkPos& pos, int minSection = 0, int maxSection = GEN_SECTIONS - 1);
+// generateTile for every tile (a position in each), all of their noise is generated as one batch
+void generateTiles(Context& ctx, ChunkGenExec& executor, std::span<const ChunkPos> tiles, int minSection = 0, int maxSection = GEN_SECTIONS - 1);
+// Generates every chunk in the rectangle that isn't in the cache (or is PARTIAL) as threads tasks on the context's pool (0 for
+// one per pool thread and the calling thread) and inserts them as FAKE chunks as they finish. Stops early if cancelFlag is set. Returns how many chunks were inserted.
+size_t pregenerateRegion(Context& ctx, const ChunkPos& min, const ChunkPos& max, int threads);
 const Chunk& getRealChunkOrDefault(Context& ctx, const ChunkPos& pos, bool solid);
+// decompresses the chunk if the compressor took it and generates the rest of it if it's PARTIAL
+Chunk& uncompressedChunk(Context& ctx, const ChunkPos& pos, std::pair<ChunkState, Chunk*>& entry);
 
 std::optional<Path> findPathFull(Context& ctx, const NodePos& start, const NodePos& goal, double fakeChunkCost);
 std::optional<Path> findPathSegment(Context& ctx, const NodePos& start, const NodePos& goal, bool x4Min, int failTimeoutMs, bool airIfFake, double fakeChunkCost);
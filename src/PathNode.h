@@ -2,28 +2,55 @@
 
 #include <cmath>
 #include <array>
+#include <cstdint>
 
 #include "Utils.h"
 
+// A node is packed into one 64 bit key: the size in the top 3 bits, then 26 bits of x and z and 9 of y (in units of the
+// node's width), which is every node in a world (-2^25 <= x, z < 2^25 and 0 <= y < 512).
+// A y outside of that wraps around to another y that is out of bounds, the search never goes there.
 struct NodePos {
-    friend struct std::hash<NodePos>;
-
-    const Size size;
 private:
-    const BlockPos pos; // absolute pos / size
+    static constexpr int SIZE_SHIFT = 61;
+    static constexpr int X_SHIFT = 35;
+    static constexpr int Z_SHIFT = 9;
+    static constexpr uint64_t XZ_MASK = 0x3FFFFFF;
+    static constexpr uint64_t Y_MASK = 0x1FF;
+
+    uint64_t key;
+
+    // the low 26 bits of bits as a signed number
+    static int signExtend26(uint64_t bits) {
+        return (int) ((uint32_t) (bits << 6)) >> 6;
+    }
 public:
-    explicit NodePos(Size enumSize, const BlockPos& approxPosition): size(enumSize), pos(approxPosition >> shiftFor(enumSize)) { }
+    explicit NodePos(Size enumSize, const BlockPos& approxPosition) {
+        const BlockPos pos = approxPosition >> shiftFor(enumSize);
+        this->key = (uint64_t) enumSize << SIZE_SHIFT
+            | ((uint64_t) pos.x & XZ_MASK) << X_SHIFT
+            | ((uint64_t) pos.z & XZ_MASK) << Z_SHIFT
+            | ((uint64_t) pos.y & Y_MASK);
+    }
+
+    [[nodiscard]] Size size() const {
+        return (Size) (this->key >> SIZE_SHIFT);
+    }
 
     BlockPos absolutePosZero() const {
-        return this->pos << shiftFor(this->size);
+        const BlockPos pos{signExtend26(this->key >> X_SHIFT), (int) (this->key & Y_MASK), signExtend26(this->key >> Z_SHIFT)};
+        return pos << shiftFor(this->size());
     }
     BlockPos absolutePosCenter() const {
-        const auto sz = width(this->size);
+        const auto sz = width(this->size());
         return this->absolutePosZero() + + (sz / 2);
     }
 
+    uint64_t pack() const {
+        return this->key;
+    }
+
     constexpr friend bool operator==(const NodePos& a, const NodePos& b) {
-        return a.pos == b.pos && a.size == b.size;
+        return a.key == b.key;
     }
 };
 
@@ -32,13 +59,9 @@ namespace std {
     template<>
     struct hash<NodePos> {
         size_t operator()(const NodePos& pos) const {
-            const auto& [x, y, z] = pos.pos;
-            size_t hash = 3241;
-            hash = 6406146L * hash + static_cast<int>(pos.size);
-            hash = 3457689L * hash + x;
-            hash = 8734625L * hash + y;
-            hash = 2873465L * hash + z;
-            return hash;
+            // the high bits of the product depend on every bit of the key, fold them down for tables that use the low ones
+            const uint64_t hash = pos.pack() * 0x9E3779B97F4A7C15ull;
+            return hash ^ (hash >> 32);
         }
     };
 }
@@ -49,19 +72,36 @@ struct PathNode {
 
     const NodePos pos;
 
-    const double estimatedCostToGoal;
-    double cost = COST_INF;
-    double combinedCost = 0;
+    // Relative to the heuristic of the start of the search, which can be millions of blocks where single precision is
+    // coarser than MIN_IMPROVEMENT. This and the cost only grow with how far the search got from its start.
+    const float estimatedCostToGoal;
+    float cost = COST_INF;
+    float combinedCost = 0;
+
+    static constexpr uint32_t NONE = UINT32_MAX;
 
-    PathNode* previous = nullptr;
+    // indices in the PathNodeArena of the search, previous is NONE for the start
+    uint32_t index;
+    uint32_t previous = NONE;
     int heapPosition = -1;
 
-    explicit PathNode(const NodePos& pos, const BlockPos& goal): pos(pos), estimatedCostToGoal(heuristic(pos, goal)) {}
+    explicit PathNode(const NodePos& pos, const BlockPos& goal, double heuristicOrigin, uint32_t index):
+        pos(pos), estimatedCostToGoal((float) (heuristic(pos, goal) - heuristicOrigin)), index(index) {}
 
     [[nodiscard]] bool isOpen() const {
         return this->heapPosition != -1;
     }
 
+    // https://rdrr.io/cran/LearnClust/src/R/octileDistance.details.R
+    // seems to work as well euclidean but im sus
+    static double heuristic(const NodePos& pos, const BlockPos& goal) {
+        const auto center = pos.absolutePosCenter();
+        // the original heuristic (turns out it sucks)
+        //return manhattan(center, goal) * 0.7 + center.distanceTo(goal) * 0.001 - (width(pos.size()) * 4);
+        //return octile(center, goal) - (width(pos.size()) * 4);
+        return center.distanceTo(goal) - (width(pos.size()) * 4);
+    }
+
 private:
     [[maybe_unused]] static int manhattan(const BlockPos& a, const BlockPos& b) {
         return abs(a.x - b.x) + abs(a.z - b.z);
@@ -74,13 +114,7 @@ private:
         return (dx + dz) + (sqrt2 - 2) * std::min(dx, dz);
     }
 
-    // https://rdrr.io/cran/LearnClust/src/R/octileDistance.details.R
-    // seems to work as well euclidean but im sus
-    static double heuristic(const NodePos& pos, const BlockPos& goal) {
-        const auto center = pos.absolutePosCenter();
-        // the original heuristic (turns out it sucks)
-        //return manhattan(center, goal) * 0.7 + center.distanceTo(goal) * 0.001 - (width(pos.size) * 4);
-        //return octile(center, goal) - (width(pos.size) * 4);
-        return center.distanceTo(goal) - (width(pos.size) * 4);
-    }
-};
\ No newline at end of file
+};
+
+// two per cache line
+static_assert(sizeof(PathNode) == 32);
\ No newline at end of file
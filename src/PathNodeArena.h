@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+#include <new>
+#include <type_traits>
+
+#include "PathNode.h"
+
+// Every node of one search. The nodes are allocated in blocks that never move so pointers to them stay valid, they are
+// referred to by their 32 bit index and are never destroyed one at a time (the whole search is a few frees).
+// They are found with an open addressing table (linear probing) that keeps the index and 32 bits of the hash of
+// NodePos::pack, so a lookup only touches a node when the hash bits match.
+struct PathNodeArena {
+private:
+    static constexpr int BLOCK_BITS = 14;
+    static constexpr uint32_t BLOCK_SIZE = 1u << BLOCK_BITS;
+    static constexpr int INITIAL_TABLE_BITS = 10;
+
+    struct Block {
+        alignas(PathNode) std::byte data[sizeof(PathNode) * BLOCK_SIZE];
+    };
+    struct Slot {
+        uint32_t hash;
+        uint32_t index = PathNode::NONE;
+    };
+
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::vector<Slot> table = std::vector<Slot>(1 << INITIAL_TABLE_BITS);
+    int tableBits = INITIAL_TABLE_BITS;
+    uint32_t count = 0;
+
+    static_assert(std::is_trivially_destructible_v<PathNode>);
+
+    static uint32_t hash(const NodePos& pos) {
+        return (uint32_t) ((pos.pack() * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    // the high bits of the hash pick the slot so the table can grow without looking at the nodes
+    size_t firstSlot(uint32_t h) const {
+        return h >> (32 - tableBits);
+    }
+
+    void grow() {
+        std::vector<Slot> old(size_t{2} << tableBits);
+        old.swap(table);
+        tableBits++;
+        const size_t mask = table.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.index == PathNode::NONE) continue;
+            size_t i = firstSlot(slot.hash);
+            while (table[i].index != PathNode::NONE) i = (i + 1) & mask;
+            table[i] = slot;
+        }
+    }
+
+public:
+    // subtracted from the heuristic of every node, see PathNode::estimatedCostToGoal
+    const double heuristicOrigin;
+
+    explicit PathNodeArena(double heuristicOrigin): heuristicOrigin(heuristicOrigin) {}
+    PathNodeArena(const PathNodeArena&) = delete;
+
+    PathNode& operator[](uint32_t index) {
+        assert(index < count);
+        return std::launder(reinterpret_cast<PathNode*>(blocks[index >> BLOCK_BITS]->data))[index & (BLOCK_SIZE - 1)];
+    }
+
+    [[nodiscard]] uint32_t size() const {
+        return this->count;
+    }
+
+    // null if there is no node at pos
+    PathNode* find(const NodePos& pos) {
+        const uint32_t h = hash(pos);
+        const size_t mask = table.size() - 1;
+        for (size_t i = firstSlot(h); table[i].index != PathNode::NONE; i = (i + 1) & mask) {
+            if (table[i].hash == h) {
+                PathNode& node = (*this)[table[i].index];
+                if (node.pos == pos) return &node;
+            }
+        }
+        return nullptr;
+    }
+
+    // never returns null
+    PathNode* getOrCreate(const NodePos& pos, const BlockPos& goal) {
+        const uint32_t h = hash(pos);
+        const size_t mask = table.size() - 1;
+        size_t i = firstSlot(h);
+        for (; table[i].index != PathNode::NONE; i = (i + 1) & mask) {
+            if (table[i].hash == h) {
+                PathNode& node = (*this)[table[i].index];
+                if (node.pos == pos) return &node;
+            }
+        }
+
+        // at most half full
+        if ((size_t) (count + 1) * 2 > table.size()) {
+            grow();
+            return getOrCreate(pos, goal);
+        }
+        if ((count & (BLOCK_SIZE - 1)) == 0) {
+            blocks.push_back(std::make_unique_for_overwrite<Block>());
+        }
+        const uint32_t index = count++;
+        table[i] = {h, index};
+        return new (blocks.back()->data + sizeof(PathNode) * (index & (BLOCK_SIZE - 1))) PathNode(pos, goal, heuristicOrigin, index);
+    }
+};
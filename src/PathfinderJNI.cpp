@@ -54,6 +54,13 @@ void throwException(JNIEnv* env, const char* msg) {
     env->ThrowNew(exception, msg);
 }
 
+// Java keeps the pointer, so the chunk must not be compressed (and freed) behind its back
+Chunk* pinnedChunk(Context& ctx, const ChunkPos& pos, std::pair<ChunkState, Chunk*>& entry) {
+    Chunk& chunk = uncompressedChunk(ctx, pos, entry);
+    ctx.compressor.pin(pos);
+    return &chunk;
+}
+
 struct State {
     jclass      pathSegmentClass{};
     jmethodID   pathSegmentCtor{};
@@ -102,7 +109,7 @@ extern "C" {
         }
     }
 
-    EXPORT Context* JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_newContext(JNIEnv* env, jclass, jlong seed, jstring baritoneCacheDir, jint dimension, jint maxHeight, jboolean pageAllocator) {
+    EXPORT Context* JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_newContext(JNIEnv* env, jclass, jlong seed, jstring baritoneCacheDir, jint dimension, jint maxHeight, jboolean pageAllocator, jint threads) {
         auto dim = static_cast<Dimension>(dimension);
         if (dimension < 0 || dimension > 2) {
             throwException(env, "Invalid dimension");
@@ -119,14 +126,18 @@ extern "C" {
             jboolean dontcare;
             const jchar* chars = env->GetStringChars(baritoneCacheDir, &dontcare);
             std::string str{chars, chars + len};
-            ctx = new Context{seed, std::move(str), dim, maxHeight, static_cast<bool>(pageAllocator)};
+            ctx = new Context{seed, std::move(str), dim, maxHeight, static_cast<bool>(pageAllocator), threads};
             env->ReleaseStringChars(baritoneCacheDir, chars);
         } else {
-            ctx = new Context{seed, dim, maxHeight, static_cast<bool>(pageAllocator)};
+            ctx = new Context{seed, dim, maxHeight, static_cast<bool>(pageAllocator), threads};
         }
         return ctx;
     }
 
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setThreadPoolSize(JNIEnv* env, jclass, jint threads, jboolean pinToCores) {
+        TaskPool::setSharedThreads(threads, pinToCores);
+    }
+
     EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_freeContext(JNIEnv* env, jclass, Context* ctx) {
         delete ctx;
     }
@@ -148,7 +159,10 @@ extern "C" {
         }
         env->ReleaseBooleanArrayElements(input, data, JNI_ABORT);
 
+        ctx->compressor.remove(ChunkPos{chunkX, chunkZ});
+        ctx->partialSections.erase(ChunkPos{chunkX, chunkZ});
         ctx->chunkCache.insert_or_assign(ChunkPos{chunkX, chunkZ}, std::pair{ChunkState::FROM_JAVA, chunk_ptr});
+        ctx->incrementalSearch.chunkChanged(ChunkPos{chunkX, chunkZ});
     }
 
     EXPORT Chunk* JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_allocateAndInsertChunk(JNIEnv*, jclass, Context* ctx, jint x, jint z) {
@@ -156,27 +170,32 @@ extern "C" {
         auto p = std::pair{ChunkState::FROM_JAVA, chunk};
         auto existing = ctx->chunkCache.find(ChunkPos{x, z});
         if (existing != ctx->chunkCache.end()) {
-            ctx->chunkAllocator->free(existing->second.second);
+            ctx->compressor.remove(ChunkPos{x, z});
+            ctx->partialSections.erase(ChunkPos{x, z});
+            if (existing->second.second) ctx->chunkAllocator->free(existing->second.second);
             existing->second = p;
         } else {
             ctx->chunkCache.emplace(ChunkPos{x, z}, p);
         }
+        ctx->incrementalSearch.chunkChanged(ChunkPos{x, z});
         return chunk;
     }
 
     EXPORT Chunk* JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getChunkOrDefault(JNIEnv*, jclass, Context* ctx, jint x, jint z, jboolean solid) {
+        std::lock_guard lock(ctx->cacheMutex);
         auto existing = ctx->chunkCache.find(ChunkPos{x, z});
         if (existing != ctx->chunkCache.end()) {
-            return existing->second.second;
+            return pinnedChunk(*ctx, ChunkPos{x, z}, existing->second);
         } else {
             return const_cast<Chunk*>(solid ? &SOLID_CHUNK : &AIR_CHUNK);
         }
     }
 
     EXPORT Chunk* JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getChunk(JNIEnv*, jclass, Context* ctx, jint x, jint z) {
+        std::lock_guard lock(ctx->cacheMutex);
         auto existing = ctx->chunkCache.find(ChunkPos{x, z});
         if (existing != ctx->chunkCache.end()) {
-            return existing->second.second;
+            return pinnedChunk(*ctx, ChunkPos{x, z}, existing->second);
         } else {
             return nullptr;
         }
@@ -185,7 +204,18 @@ extern "C" {
     EXPORT jboolean JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setChunkState(JNIEnv* env, jclass clazz, Context* ctx, jint x, jint z, jboolean fromJava) {
         auto it = ctx->chunkCache.find(ChunkPos{x, z});
         if (it != ctx->chunkCache.end()) {
-            it->second.first = fromJava ? ChunkState::FROM_JAVA : ChunkState::FAKE;
+            if (fromJava) {
+                // the compressor only takes FAKE chunks (and this generates the rest of PARTIAL ones)
+                uncompressedChunk(*ctx, ChunkPos{x, z}, it->second);
+                ctx->compressor.remove(ChunkPos{x, z});
+                it->second.first = ChunkState::FROM_JAVA;
+                ctx->incrementalSearch.chunkChanged(ChunkPos{x, z});
+            } else if (it->second.first == ChunkState::FROM_JAVA) {
+                // PARTIAL chunks stay PARTIAL
+                it->second.first = ChunkState::FAKE;
+                // the blocks are the same but the steps into them cost more now
+                ctx->incrementalSearch.chunkChanged(ChunkPos{x, z});
+            }
             return true;
         }
         return false;
@@ -204,14 +234,128 @@ extern "C" {
     EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_cullFarChunks(JNIEnv*, jclass, Context* ctx, jint chunkX, jint chunkZ, jint maxDistanceBlocks) {
         const auto distSqBlocks = (maxDistanceBlocks / 16) * (maxDistanceBlocks / 16);
         const auto distSq = distSqBlocks;
+        ctx->compressor.cancelPending();
         std::erase_if(ctx->chunkCache, [=](const auto& item) {
             const auto cpos = item.first;
             bool out = cpos.distanceToSq({chunkX, chunkZ}) > distSq;
-            if (out) ctx->chunkAllocator->free(item.second.second);
+            if (out) {
+                ctx->compressor.remove(cpos);
+                ctx->partialSections.erase(cpos);
+                ctx->incrementalSearch.chunkChanged(cpos);
+                if (item.second.second) ctx->chunkAllocator->free(item.second.second);
+            }
             return out;
         });
     }
 
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setChunkCompression(JNIEnv* env, jclass, Context* ctx, jint coldAfterMs) {
+        if (coldAfterMs < 0) {
+            throwException(env, "coldAfterMs must not be negative");
+            return;
+        }
+        ctx->compressor.setColdTime(std::chrono::milliseconds{coldAfterMs});
+    }
+
+    EXPORT jlongArray JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getChunkCompressionStats(JNIEnv* env, jclass, Context* ctx) {
+        const std::array<jlong, 4> stats {
+            (jlong) ctx->compressor.hits.load(std::memory_order_relaxed),
+            (jlong) ctx->compressor.misses.load(std::memory_order_relaxed),
+            (jlong) ctx->compressor.compressedChunks(),
+            (jlong) ctx->compressor.compressedBytes()
+        };
+        jlongArray array = env->NewLongArray(stats.size());
+        env->SetLongArrayRegion(array, 0, stats.size(), stats.data());
+        return array;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setNoiseColumnCache(JNIEnv* env, jclass, Context* ctx, jint maxColumns) {
+        if (maxColumns < 0) {
+            throwException(env, "maxColumns must not be negative");
+            return;
+        }
+        ctx->generator.columnCache.setCapacity(maxColumns);
+    }
+
+    EXPORT jlongArray JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getNoiseColumnCacheStats(JNIEnv* env, jclass, Context* ctx) {
+        NoiseColumnCache& cache = ctx->generator.columnCache;
+        const std::array<jlong, 5> stats {
+            (jlong) cache.hits.load(std::memory_order_relaxed),
+            (jlong) cache.misses.load(std::memory_order_relaxed),
+            (jlong) cache.size(),
+            (jlong) cache.generatedChunks.load(std::memory_order_relaxed),
+            (jlong) cache.generateNanos.load(std::memory_order_relaxed)
+        };
+        jlongArray array = env->NewLongArray(stats.size());
+        env->SetLongArrayRegion(array, 0, stats.size(), stats.data());
+        return array;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setSpeculativeGeneration(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->pregenerator.setEnabled(enabled);
+    }
+
+    EXPORT jlongArray JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getSpeculativeGenerationStats(JNIEnv* env, jclass, Context* ctx) {
+        const std::array<jlong, 2> stats {
+            (jlong) ctx->pregenerator.generated.load(std::memory_order_relaxed),
+            (jlong) ctx->pregenerator.used.load(std::memory_order_relaxed)
+        };
+        jlongArray array = env->NewLongArray(stats.size());
+        env->SetLongArrayRegion(array, 0, stats.size(), stats.data());
+        return array;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setLazySectionGeneration(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->lazySections = enabled;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setBidirectionalSearch(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->bidirectional = enabled;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setSymmetryPruning(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->symmetryPruning = enabled;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setIncrementalReplanning(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->incrementalReplanning = enabled;
+        if (!enabled) ctx->incrementalSearch.reset();
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setAnytimeSearch(JNIEnv* env, jclass, Context* ctx, jboolean enabled) {
+        ctx->anytimeSearch = enabled;
+    }
+
+    EXPORT void JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_setOpenSet(JNIEnv* env, jclass, Context* ctx, jint type) {
+        if (type < (jint) OpenSetType::BINARY_HEAP_POINTERS || type > (jint) OpenSetType::BUCKETS) {
+            throwException(env, "bad open set type");
+            return;
+        }
+        ctx->openSet = (OpenSetType) type;
+    }
+
+    EXPORT jlong JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_pregenerate(JNIEnv* env, jclass, Context* ctx, jint minChunkX, jint minChunkZ, jint maxChunkX, jint maxChunkZ, jint threads) {
+        if (minChunkX > maxChunkX || minChunkZ > maxChunkZ) {
+            throwException(env, "min chunk must not be greater than max chunk");
+            return 0;
+        }
+        if (threads < 0) {
+            throwException(env, "threads must not be negative");
+            return 0;
+        }
+        ctx->cancelFlag.clear();
+        return (jlong) pregenerateRegion(*ctx, ChunkPos{minChunkX, minChunkZ}, ChunkPos{maxChunkX, maxChunkZ}, threads);
+    }
+
+    EXPORT jlongArray JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_getPregenerationProgress(JNIEnv* env, jclass, Context* ctx) {
+        const std::array<jlong, 2> stats {
+            (jlong) ctx->regionChunksDone.load(std::memory_order_relaxed),
+            (jlong) ctx->regionChunksTotal.load(std::memory_order_relaxed)
+        };
+        jlongArray array = env->NewLongArray(stats.size());
+        env->SetLongArrayRegion(array, 0, stats.size(), stats.data());
+        return array;
+    }
+
     EXPORT jobject JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_pathFind(JNIEnv* env, jclass, Context* ctx, jint x1, jint y1, jint z1, jint x2, jint y2, jint z2, jboolean x4Min, jboolean refineResult, jint timeoutMs, jboolean airIfFake, jdouble fakeChunkCost) {
         if (!inBounds(y1) || !inBounds(y2)) {
             throwException(env, "Invalid y1 or y2");
@@ -248,6 +392,7 @@ extern "C" {
     }
 
     EXPORT jboolean JNICALL Java_dev_babbaj_pathfinder_NetherPathfinder_cancel(JNIEnv* env, jclass clazz, Context* ctx) {
+        ctx->pregenerator.cancel();
         return ctx->cancelFlag.test_and_set();
     }
     
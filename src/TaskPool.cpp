@@ -0,0 +1,225 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace {
+    // the pool the current thread is a worker of and its queue
+    thread_local const TaskPool* currentPool = nullptr;
+    thread_local size_t currentQueue = 0;
+
+    std::mutex sharedMutex;
+    std::shared_ptr<TaskPool> sharedPool;
+
+    // A wait usually ends within a few microseconds (the tasks are noise for one tile), so spinning that long saves the
+    // futex wake. Each thread doubles its spins when they were enough and halves them when it had to sleep anyway.
+    constexpr int MIN_SPINS = 16;
+    constexpr int MAX_SPINS = 4096; // around 50-200us depending on how long the cpu pauses
+    thread_local int spinLimit = MIN_SPINS;
+
+    // spinning on one core only delays the thread we're waiting for
+    const bool canSpin = std::thread::hardware_concurrency() > 1;
+
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // the first logical cpu of every physical core we're allowed to run on
+    std::vector<int> physicalCores() {
+        std::vector<int> cores;
+#ifdef _WIN32
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!GetLogicalProcessorInformation(info.data(), &length)) return {};
+        for (const auto& i : info) {
+            if (i.Relationship == RelationProcessorCore && i.ProcessorMask != 0) {
+                cores.push_back(std::countr_zero((uint64_t) i.ProcessorMask));
+            }
+        }
+#elif defined(__linux__)
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+        std::vector<std::pair<int, int>> seen; // {package, core}
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            auto readId = [cpu](const char* name) {
+                char path[128];
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+                FILE* file = fopen(path, "r");
+                int id = -1;
+                if (file) {
+                    if (fscanf(file, "%d", &id) != 1) id = -1;
+                    fclose(file);
+                }
+                return id;
+            };
+            const std::pair id{readId("physical_package_id"), readId("core_id")};
+            // without the topology every logical cpu counts as a core
+            if (id.second < 0 || std::find(seen.begin(), seen.end(), id) == seen.end()) {
+                seen.push_back(id);
+                cores.push_back(cpu);
+            }
+        }
+#endif
+        return cores;
+    }
+
+    void pinCurrentThread(int cpu) {
+#ifdef _WIN32
+        if (cpu < 64) SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu);
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+#endif
+    }
+}
+
+TaskPool::TaskPool(int threads, bool pinThreads) {
+    threads = std::max(threads, 0);
+    const std::vector<int> cores = pinThreads ? physicalCores() : std::vector<int>{};
+    for (int i = 0; i <= threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threads; i++) {
+        const int cpu = i + 1 < (int) cores.size() ? cores[i + 1] : -1;
+        workers.emplace_back([this, i, cpu] { run(i, cpu); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    stopRequest.store(true, std::memory_order_release);
+    notify();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+std::shared_ptr<TaskPool> TaskPool::shared() {
+    std::lock_guard lock(sharedMutex);
+    if (!sharedPool) {
+        sharedPool = std::make_shared<TaskPool>(defaultThreads());
+    }
+    return sharedPool;
+}
+
+void TaskPool::setSharedThreads(int threads, bool pinThreads) {
+    std::shared_ptr<TaskPool> old;
+    {
+        std::lock_guard lock(sharedMutex);
+        old = std::move(sharedPool);
+        sharedPool = std::make_shared<TaskPool>(threads < 0 ? defaultThreads() : threads, pinThreads);
+    }
+    // the old workers are joined here (if nothing else has the pool) without holding the lock
+}
+
+int TaskPool::defaultThreads() {
+    return (int) std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
+
+size_t TaskPool::ownQueue() const {
+    return currentPool == this ? currentQueue : queues.size() - 1;
+}
+
+void TaskPool::submit(Task task) {
+    Queue& q = *queues[ownQueue()];
+    {
+        std::lock_guard lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    notify();
+}
+
+void TaskPool::wake() {
+    notify();
+}
+
+void TaskPool::notify() {
+    // A sleeper counts itself before it reads epoch and checks for work, so either it sees the new epoch
+    // (and whatever changed before it) or we see it and wake it up. Both sides have to be seq_cst for that.
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) == 0) return;
+    // everyone, a thread in helpUntil that wakes up to see it's done would leave a new task to nobody
+    epoch.notify_all();
+}
+
+bool TaskPool::runOne(size_t own) {
+    if (queued.load(std::memory_order_acquire) == 0) return false;
+    Task task;
+    const bool worker = own != queues.size() - 1;
+    // workers take their own newest task (the last fork of what they're running), everything else is taken oldest first
+    for (size_t i = 0; i < queues.size() && !task; i++) {
+        const size_t index = (own + i) % queues.size();
+        Queue& q = *queues[index];
+        std::lock_guard lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        if (i == 0 && worker) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (!task) return false;
+    task();
+    return true;
+}
+
+void TaskPool::sleep(const std::function<bool()>& done) {
+    auto ready = [&] {
+        return queued.load(std::memory_order_acquire) != 0 || stopRequest.load(std::memory_order_acquire) || done();
+    };
+    if (canSpin) {
+        for (int i = 0; i < spinLimit; i++) {
+            if (ready()) {
+                spinLimit = std::min(spinLimit * 2, MAX_SPINS);
+                return;
+            }
+            cpuRelax();
+        }
+        spinLimit = std::max(spinLimit / 2, MIN_SPINS);
+    }
+
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    const uint32_t seen = epoch.load(std::memory_order_seq_cst);
+    if (!ready()) {
+        epoch.wait(seen, std::memory_order_seq_cst);
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TaskPool::helpUntil(const std::function<bool()>& done) {
+    const size_t own = ownQueue();
+    while (!done()) {
+        if (!runOne(own)) {
+            sleep(done);
+        }
+    }
+}
+
+void TaskPool::run(size_t index, int cpu) {
+    currentPool = this;
+    currentQueue = index;
+    if (cpu >= 0) pinCurrentThread(cpu);
+    while (true) {
+        if (runOne(index)) continue;
+        if (stopRequest.load(std::memory_order_acquire) && queued.load(std::memory_order_acquire) == 0) return;
+        sleep([] { return false; });
+    }
+}
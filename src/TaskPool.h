@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// A fixed number of worker threads with a task deque each. Workers take their own newest task first and steal the oldest
+// tasks of the others when they run out. Threads that wait for tasks (ParallelExecutor::compute) run queued tasks while
+// they wait instead of blocking, so nested forks run on the threads that are already there and never add more.
+// A thread with nothing to run spins for a while (longer if that has been working for it lately) and then sleeps on a futex.
+struct TaskPool {
+    using Task = std::function<void()>;
+
+    // threads is the number of workers, with 0 every task runs on the threads that wait for it.
+    // pinThreads puts every worker on its own physical core (skipping the first one, which is left to the calling threads)
+    // where the os lets us, with more workers than cores the rest aren't pinned.
+    explicit TaskPool(int threads, bool pinThreads = false);
+    TaskPool(const TaskPool&) = delete;
+    ~TaskPool();
+
+    int threads() const {
+        return (int) workers.size();
+    }
+
+    // Queues a task. A worker queues it on its own deque, every other thread on the deque shared by the threads outside the pool.
+    void submit(Task task);
+    // Runs queued tasks until done is true and sleeps when there are none. done is checked again after every wake().
+    void helpUntil(const std::function<bool()>& done);
+    // Wakes the threads in helpUntil, call it after changing what their done checks
+    void wake();
+
+    // The pool that executors without their own pool use, it's created with defaultThreads() workers when it's first used
+    static std::shared_ptr<TaskPool> shared();
+    // Replaces the shared pool with one of threads workers (defaultThreads() if negative). Whoever still has the old one
+    // (like a Context made before) keeps using it.
+    static void setSharedThreads(int threads, bool pinThreads = false);
+    // one less than the number of cores, the thread that calls into the library works too
+    static int defaultThreads();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // queues[i] belongs to workers[i], the last one is shared by every other thread
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic_size_t queued{};
+    // sleeping threads wait for this to change, every submit and wake changes it
+    std::atomic_uint32_t epoch{};
+    std::atomic_uint32_t sleepers{};
+    std::atomic_bool stopRequest{false};
+
+    // index of the queue of the calling thread
+    size_t ownQueue() const;
+    bool runOne(size_t own);
+    void notify();
+    void sleep(const std::function<bool()>& done);
+    void run(size_t index, int cpu);
+};
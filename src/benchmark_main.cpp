@@ -1,5 +1,8 @@
 #include <random>
 #include <array>
+#include <vector>
+#include <cstring>
+#include <chrono>
 
 #include <benchmark/benchmark.h>
 
@@ -108,16 +111,373 @@ static void BM_testGenChunk(benchmark::State& state) {
     }
 }
 
-static void BM_testPathFind(benchmark::State& state) {
+// same area as BM_testGenChunk
+static void BM_testGenChunkTiles(benchmark::State& state) {
+    ChunkGenExec exec;
+    const int size = state.range(0);
+    std::vector<Chunk> chunks(size * size);
+    std::vector<Chunk*> pointers;
+    for (Chunk& chunk : chunks) pointers.push_back(&chunk);
+
+    for (auto _ : state) {
+        for (int x = 0; x < 100; x += size) {
+            for (int z = 0; z < 100; z += size) {
+                generator.generateChunks(x, z, size, size, pointers.data(), exec);
+                benchmark::DoNotOptimize(chunks);
+            }
+        }
+    }
+}
+
+// What a search entering a chunk generates: the 3 tiles around a chunk corner with range(0) chunks of the 12 already cached.
+// range(1) = 1 generates them as one generateTiles batch, 0 like before with a generateTile per tile at the same time.
+static void BM_generateNeighbourTiles(benchmark::State& state) {
+    ChunkGenExec exec{std::make_shared<TaskPool>(3)};
+    const int cached = (int) state.range(0);
+    std::array<Chunk, 12> chunks;
+    std::array<Chunk*, 12> pointers;
+    for (int i = 0; i < 12; i++) {
+        pointers[i] = i % 4 < cached / 3 + (i / 4 < cached % 3) ? nullptr : &chunks[i];
+    }
+    int i = 0;
+    for (auto _ : state) {
+        const int x = i++ * 4;
+        const std::array<ChunkGeneratorHell::TileRequest, 3> tiles{{
+            {x, 0, 2, &pointers[0], 0, GEN_SECTIONS - 1},
+            {x + 2, 0, 2, &pointers[4], 0, GEN_SECTIONS - 1},
+            {x, 2, 2, &pointers[8], 0, GEN_SECTIONS - 1}
+        }};
+        if (state.range(1)) {
+            generator.generateTiles(tiles, exec);
+        } else {
+            exec.forEach(3, [&](int t) {
+                generator.generateTile(tiles[t].x, tiles[t].z, 2, tiles[t].chunks, exec);
+            });
+        }
+        benchmark::DoNotOptimize(chunks);
+    }
+}
+
+// same area as BM_testGenChunk, every iteration starts with an empty cache
+static void BM_testGenChunkColumnCache(benchmark::State& state) {
     ChunkGenExec exec;
 
     for (auto _ : state) {
-        cache_t cache;
-        auto path = findPath({0, 40, 0}, {(int)state.range(0), 64, (int)state.range(0)}, generator, false);
+        generator.columnCache.setCapacity(1 << 16);
+        for (int x = 0; x < 100; x++) {
+            for (int z = 0; z < 100; z++) {
+                auto chunk = generator.generateChunk(x, z, exec);
+                benchmark::DoNotOptimize(chunk);
+            }
+        }
+        generator.columnCache.setCapacity(0);
+    }
+    const double hits = generator.columnCache.hits;
+    state.counters["hitRate"] = hits / (hits + generator.columnCache.misses);
+}
+
+static void BM_testPathFind(benchmark::State& state) {
+    for (auto _ : state) {
+        Context ctx{seed, Dimension::Nether, 128, true};
+        const NodePos start{Size::X4, {0, 40, 0}};
+        const NodePos goal{Size::X4, {(int)state.range(0), 64, (int)state.range(0)}};
+        auto path = findPathSegment(ctx, start, goal, true, 0, false, 1);
         benchmark::DoNotOptimize(path);
     }
 }
 
+// A context with the 97 * 97 chunks around 0, 0 generated and the searches of BM_openSet, made on first use.
+// Searches that don't reach their goal are left out, they would only measure the timeout.
+struct SearchSet {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    std::vector<std::pair<NodePos, NodePos>> searches;
+
+    SearchSet() {
+        pregenerateRegion(ctx, {-48, -48}, {48, 48}, 0);
+        std::mt19937 rand{seed};
+        std::uniform_int_distribution<int> coord(-600, 600), y(20, 100);
+        for (int i = 0; i < 64; i++) {
+            const BlockPos a{coord(rand), y(rand), coord(rand)}, b{coord(rand), y(rand), coord(rand)};
+            const NodePos start = findAir<Size::X2>(ctx, a), goal = findAir<Size::X2>(ctx, b);
+            const auto path = findPathSegment(ctx, start, goal, false, 0, false, 1);
+            if (path && path->type == Path::Type::FINISHED) {
+                searches.emplace_back(start, goal);
+            }
+        }
+    }
+
+    static SearchSet& get() {
+        static SearchSet set;
+        return set;
+    }
+
+    std::vector<std::optional<Path>> run(OpenSetType openSet) {
+        ctx.openSet = openSet;
+        std::vector<std::optional<Path>> paths;
+        for (const auto& [start, goal] : searches) {
+            paths.push_back(findPathSegment(ctx, start, goal, false, 0, false, 1));
+        }
+        return paths;
+    }
+};
+
+// The same (up to 64) searches of 2x nodes with the open set state.range(0) (an OpenSetType)
+static void BM_openSet(benchmark::State& state) {
+    SearchSet& set = SearchSet::get();
+    const auto openSet = (OpenSetType) state.range(0);
+    const auto paths = set.run(openSet);
+    if (openSet == OpenSetType::BINARY_HEAP) {
+        // the inline binary heap has to order the nodes exactly like the old one
+        const auto expected = set.run(OpenSetType::BINARY_HEAP_POINTERS);
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (paths[i].has_value() != expected[i].has_value() || (paths[i] && paths[i]->blocks != expected[i]->blocks)) {
+                state.SkipWithError("BINARY_HEAP found a different path than BINARY_HEAP_POINTERS");
+                return;
+            }
+        }
+    }
+    size_t blocks = 0;
+    for (const auto& path : paths) {
+        if (path) blocks += path->blocks.size();
+    }
+    state.counters["blocks"] = (double) blocks;
+
+    for (auto _ : state) {
+        auto result = set.run(openSet);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Three 10k block searches with and without Context::bidirectional (state.range(0)). The chunks are generated before
+// the timing starts so this only measures the searches. cost is the total number of steps of the paths.
+static void BM_bidirectionalSearch(benchmark::State& state) {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    std::vector<std::pair<NodePos, NodePos>> routes;
+    for (int i = 0; i < 3; i++) {
+        const BlockPos a{i * 500, 64, -i * 300};
+        routes.emplace_back(findAir<Size::X4>(ctx, a), findAir<Size::X4>(ctx, {a.x + 10000, 64, a.z + 3333}));
+    }
+    for (const bool bidirectional : {false, true}) {
+        ctx.bidirectional = bidirectional;
+        for (const auto& [start, goal] : routes) {
+            findPathSegment(ctx, start, goal, true, 60000, false, 1);
+        }
+    }
+
+    ctx.bidirectional = state.range(0);
+    double cost = 0;
+    int finished = 0;
+    for (const auto& [start, goal] : routes) {
+        const auto path = findPathSegment(ctx, start, goal, true, 60000, false, 1);
+        if (!path) {
+            state.SkipWithError("no path");
+            return;
+        }
+        cost += (double) path->nodes.size() - 1;
+        finished += path->type == Path::Type::FINISHED;
+    }
+    state.counters["cost"] = cost;
+    state.counters["finished"] = finished;
+
+    for (auto _ : state) {
+        for (const auto& [start, goal] : routes) {
+            auto path = findPathSegment(ctx, start, goal, true, 60000, false, 1);
+            benchmark::DoNotOptimize(path);
+        }
+    }
+}
+
+// Eight routes through an open cavern (empty chunks from Java) with a wall across it that has a gap at one end, with
+// and without Context::symmetryPruning (state.range(0)). cost is the total cost of the paths, which pruning shouldn't change.
+static void BM_symmetryPruning(benchmark::State& state) {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    for (int x = -64; x < 64; x++) {
+        for (int z = -64; z < 64; z++) {
+            Chunk* chunk = ctx.chunkAllocator->allocate();
+            *chunk = Chunk{};
+            if (x == 0 && z < 40) {
+                for (int y = 0; y < 128; y++) {
+                    for (int localZ = 0; localZ < 16; localZ++) chunk->setBlock(0, y, localZ, true);
+                }
+            }
+            ctx.chunkCache.emplace(ChunkPos{x, z}, std::pair{ChunkState::FROM_JAVA, chunk});
+        }
+    }
+    std::vector<std::pair<NodePos, NodePos>> routes;
+    for (int i = 0; i < 8; i++) {
+        const BlockPos a{-900 + i * 120, 50, -750 + i * 60}, b{750 - i * 90, 60 + i * 8, 840 - i * 150};
+        routes.emplace_back(findAir<Size::X4>(ctx, a), findAir<Size::X4>(ctx, b));
+    }
+    // pruning can change the cost on generated terrain, but through open space it finds paths as cheap as without it
+    double costs[2]{};
+    for (const bool pruning : {false, true}) {
+        ctx.symmetryPruning = pruning;
+        for (const auto& [start, goal] : routes) {
+            const auto path = findPathSegment(ctx, start, goal, true, 0, false, 1);
+            if (!path || path->type != Path::Type::FINISHED) {
+                state.SkipWithError("a route through the cavern wasn't finished");
+                return;
+            }
+            costs[pruning] += path->nodes.back().cost;
+        }
+    }
+    if (costs[0] != costs[1]) {
+        state.SkipWithError("pruning changed the cost of the routes through the cavern");
+        return;
+    }
+    ctx.symmetryPruning = state.range(0);
+    state.counters["cost"] = costs[1];
+
+    for (auto _ : state) {
+        for (const auto& [start, goal] : routes) {
+            auto path = findPathSegment(ctx, start, goal, true, 0, false, 1);
+            benchmark::DoNotOptimize(path);
+        }
+    }
+}
+
+// A player walking a 3000 block route: every replan starts a few nodes further along and the chunks around the
+// player have arrived from the game since the last one (they cost less than fake ones)
+static void BM_incrementalReplanning(benchmark::State& state) {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    pregenerateRegion(ctx, {-10, -10}, {200, 10}, 0);
+    const NodePos goal = findAir<Size::X4>(ctx, {3000, 60, 30});
+    const auto route = findPathSegment(ctx, findAir<Size::X4>(ctx, {0, 50, 0}), goal, true, 0, false, 2);
+    if (!route || route->type != Path::Type::FINISHED) {
+        state.SkipWithError("the route wasn't finished");
+        return;
+    }
+    std::vector<NodePos> starts;
+    for (size_t i = 0; i < route->nodes.size() && starts.size() < 100; i += 3) {
+        starts.push_back(route->nodes[i].pos);
+    }
+    ctx.incrementalReplanning = state.range(0);
+    // the first plan of the incremental search isn't a replan
+    findPathSegment(ctx, starts.front(), goal, true, 0, false, 2);
+
+    size_t next = 0;
+    double cost = 0;
+    int64_t plans = 0;
+    for (auto _ : state) {
+        const NodePos& start = starts[next++ % starts.size()];
+        const ChunkPos player = start.absolutePosZero().toChunkPos();
+        for (int x = player.x - 2; x <= player.x + 2; x++) {
+            for (int z = player.z - 2; z <= player.z + 2; z++) {
+                auto it = ctx.chunkCache.find(ChunkPos{x, z});
+                if (it == ctx.chunkCache.end() || it->second.first == ChunkState::FROM_JAVA) continue;
+                uncompressedChunk(ctx, ChunkPos{x, z}, it->second);
+                ctx.compressor.remove(ChunkPos{x, z});
+                it->second.first = ChunkState::FROM_JAVA;
+                ctx.incrementalSearch.chunkChanged(ChunkPos{x, z});
+            }
+        }
+        const auto path = findPathSegment(ctx, start, goal, true, 0, false, 2);
+        if (!path || path->type != Path::Type::FINISHED) {
+            state.SkipWithError("a replan wasn't finished");
+            return;
+        }
+        cost += path->nodes.back().cost;
+        plans++;
+    }
+    state.counters["cost"] = cost / (double) plans;
+}
+
+// The first plans of the incremental search on the routes of BM_anytimeSearch against the normal search from scratch.
+// Its paths can cost more or less than those (see setIncrementalReplanning), this fails if they cost 25% more in total.
+static void BM_incrementalPathCost(benchmark::State& state) {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    pregenerateRegion(ctx, {-40, -40}, {40, 40}, 0);
+    std::vector<std::pair<NodePos, NodePos>> routes;
+    for (int i = 0; i < 8; i++) {
+        const BlockPos a{-300 + i * 40, 50, -250 + i * 20}, b{250 - i * 30, 60, 280 - i * 50};
+        routes.emplace_back(findAir<Size::X4>(ctx, a), findAir<Size::X4>(ctx, b));
+    }
+    auto totalCost = [&](bool incremental) -> std::optional<double> {
+        ctx.incrementalReplanning = incremental;
+        double cost = 0;
+        for (const auto& [start, goal] : routes) {
+            // every route has another goal so the incremental search starts over
+            const auto path = findPathSegment(ctx, start, goal, true, 0, false, 1);
+            if (!path || path->type != Path::Type::FINISHED) return std::nullopt;
+            cost += path->nodes.back().cost;
+        }
+        return cost;
+    };
+    const auto scratchCost = totalCost(false);
+    const auto incrementalCost = totalCost(true);
+    if (!scratchCost || !incrementalCost) {
+        state.SkipWithError("a route wasn't finished");
+        return;
+    }
+    if (*incrementalCost > *scratchCost * 1.25) {
+        state.SkipWithError("the incremental paths cost more than 25% more than the normal ones");
+        return;
+    }
+    state.counters["scratchCost"] = *scratchCost;
+    state.counters["incrementalCost"] = *incrementalCost;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(totalCost(true));
+    }
+}
+
+// 8 routes of up to 800 blocks through generated chunks. The anytime search runs until its path is the cheapest one or
+// 500 ms are over, firstMs is how long the complete paths it found first took
+static void BM_anytimeSearch(benchmark::State& state) {
+    Context ctx{seed, Dimension::Nether, 128, true};
+    pregenerateRegion(ctx, {-40, -40}, {40, 40}, 0);
+    std::vector<std::pair<NodePos, NodePos>> routes;
+    for (int i = 0; i < 8; i++) {
+        const BlockPos a{-300 + i * 40, 50, -250 + i * 20}, b{250 - i * 30, 60, 280 - i * 50};
+        routes.emplace_back(findAir<Size::X4>(ctx, a), findAir<Size::X4>(ctx, b));
+    }
+    ctx.anytimeSearch = state.range(0);
+    double cost = 0, firstCost = 0, bound = 0;
+    double firstMs = 0;
+    std::chrono::steady_clock::time_point startTime;
+    bool first = true;
+    ctx.anytimeProgress = [&](const Path& path) {
+        if (!first) return;
+        first = false;
+        firstCost += path.nodes.back().cost;
+        firstMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    };
+    for (auto _ : state) {
+        cost = firstCost = bound = firstMs = 0;
+        for (const auto& [start, goal] : routes) {
+            first = true;
+            startTime = std::chrono::steady_clock::now();
+            const auto path = findPathSegment(ctx, start, goal, true, 0, false, 1);
+            if (!path || path->type != Path::Type::FINISHED) {
+                state.SkipWithError("a route wasn't finished");
+                return;
+            }
+            cost += path->nodes.back().cost;
+            bound = std::max(bound, path->bound);
+        }
+    }
+    state.counters["cost"] = cost;
+    if (state.range(0)) {
+        state.counters["firstCost"] = firstCost;
+        state.counters["firstMs"] = firstMs;
+        state.counters["worstBound"] = bound;
+    }
+}
+
+// 64 * 64 chunks on state.range(0) threads, every iteration starts with an empty cache
+static void BM_pregenerateRegion(benchmark::State& state) {
+    std::unique_ptr<Context> ctx;
+    for (auto _ : state) {
+        state.PauseTiming();
+        ctx.reset(); // freeing the last one isn't timed either
+        ctx = std::make_unique<Context>(seed, Dimension::Nether, 128, true);
+        state.ResumeTiming();
+        const size_t chunks = pregenerateRegion(*ctx, {0, 0}, {63, 63}, (int) state.range(0));
+        benchmark::DoNotOptimize(chunks);
+    }
+    state.SetItemsProcessed(state.iterations() * 64 * 64);
+}
+
 static void BM_testParallelExecutor(benchmark::State& state) {
     ChunkGenExec exec;
 
@@ -155,6 +515,163 @@ void BM_generateNoiseOctaves(benchmark::State& state) {
     }
 }
 
+// how getHeights used to split the work, one generator per thread
+std::array<double, 5 * 17 * 5> getHeightsPerGenerator(int x, int z, ChunkGenExec& exec) {
+    auto [pnr, ar, br] = exec.compute(
+        [=] { return generator.perlinNoise1.generateNoiseOctaves<5, 17, 5>(x, 0, z, 8.555150000000001, 34.2206, 8.555150000000001); },
+        [=] { return generator.lperlinNoise1.generateNoiseOctaves<5, 17, 5>(x, 0, z, 684.412, 2053.236, 684.412); },
+        [=] { return generator.lperlinNoise2.generateNoiseOctaves<5, 17, 5>(x, 0, z, 684.412, 2053.236, 684.412); }
+    );
+    std::array<double, 5 * 17 * 5> buffer{};
+    ChunkGeneratorHell::noiseToHeights<17>(buffer.data(), pnr.data(), ar.data(), br.data(), 5 * 5);
+    return buffer;
+}
+
+void BM_getHeightsPerGenerator(benchmark::State& state) {
+    ChunkGenExec exec;
+    int i = 0;
+    for (auto _ : state) {
+        auto heights = getHeightsPerGenerator(i++ * 4, 0, exec);
+        benchmark::DoNotOptimize(heights);
+    }
+}
+
+// The same 3 noise generators on an executor with threads (1) and without (0). With the tasks really running
+// at the same time the threaded version should take about as long as the biggest task, not the sum of all 3.
+static void BM_parallelExecutorCompute(benchmark::State& state) {
+    ChunkGenExec exec{state.range(0) != 0};
+    int i = 0;
+    for (auto _ : state) {
+        auto heights = getHeightsPerGenerator(i++ * 4, 0, exec);
+        benchmark::DoNotOptimize(heights);
+    }
+}
+
+// The caller waits about range(0) us for 2 workers (pinned to cores if range(1) is set). The real time should stay close
+// to the task time and the cpu time (of every thread) close to twice that, a busy waiting caller would make it 3 times.
+static void BM_parallelExecutorWait(benchmark::State& state) {
+    ChunkGenExec exec{std::make_shared<TaskPool>(2, state.range(1) != 0)};
+    const auto work = std::chrono::microseconds(state.range(0));
+    auto busy = [work] {
+        const auto end = std::chrono::steady_clock::now() + work;
+        while (std::chrono::steady_clock::now() < end);
+        return 0;
+    };
+    for (auto _ : state) {
+        auto result = exec.compute(busy, busy, [] { return 0; });
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void BM_getHeights(benchmark::State& state) {
+    ChunkGenExec exec;
+    for (int i = 0; i < 64; i++) {
+        if (generator.getHeights<5, 17, 5>(i * 4, 0, i * 12, exec) != getHeightsPerGenerator(i * 4, i * 12, exec)) {
+            state.SkipWithError("output does not match the per generator split");
+            return;
+        }
+    }
+    int i = 0;
+    for (auto _ : state) {
+        auto heights = generator.getHeights<5, 17, 5>(i++ * 4, 0, 0, exec);
+        benchmark::DoNotOptimize(heights);
+    }
+}
+
+using PopulateNoiseArray = decltype(&NoiseGeneratorImproved::populateNoiseArray);
+
+// Every implementation has to match the scalar code exactly or generated chunks won't match the server
+bool matchesScalar(PopulateNoiseArray impl) {
+    Random rand{seed};
+    std::mt19937_64 gen{seed};
+    std::uniform_real_distribution<double> offset(-30000000.0, 30000000.0);
+    constexpr double scales[] = {684.412, 2053.236, 8.555150000000001, 34.2206, 0.5, 0.001};
+    for (int g = 0; g < 100; g++) {
+        const NoiseGeneratorImproved noise{rand};
+        for (int i = 0; i < 500; i++) {
+            const int ySize = 2 + i % 31;
+            const double noiseScale = 1.0 / (1 << (i % 16));
+            std::vector<double> expected(5 * ySize * 5, 0.5);
+            std::vector<double> actual = expected;
+            const double xo = offset(gen), yo = offset(gen) / 1024, zo = offset(gen);
+            const double xs = scales[i % 6], ys = scales[(i / 6) % 6], zs = scales[(i / 36) % 6];
+            const int xStart = i % 3, yStart = i % 7, zStart = i % 5;
+            noise.populateNoiseArrayScalar(expected.data(), xo, yo, zo, 5, ySize, 5, xs, ys, zs, noiseScale, xStart, yStart, zStart);
+            (noise.*impl)(actual.data(), xo, yo, zo, 5, ySize, 5, xs, ys, zs, noiseScale, xStart, yStart, zStart);
+            if (memcmp(expected.data(), actual.data(), expected.size() * sizeof(double)) != 0) return false;
+        }
+    }
+    return true;
+}
+
+void benchmarkPopulateNoiseArray(benchmark::State& state, PopulateNoiseArray impl) {
+    if (!matchesScalar(impl)) {
+        state.SkipWithError("output does not match populateNoiseArrayScalar");
+        return;
+    }
+    const NoiseGeneratorImproved& noise = generator.lperlinNoise1.generators[0];
+    std::array<double, 5 * 17 * 5> noiseArray{};
+    int i = 0;
+    for (auto _ : state) {
+        const double offset = (i++ % 1000) * 4.0 * 684.412;
+        (noise.*impl)(noiseArray.data(), offset, 0, offset, 5, 17, 5, 684.412, 2053.236, 684.412, 1.0, 0, 0, 0);
+        benchmark::DoNotOptimize(noiseArray);
+    }
+    state.SetItemsProcessed(state.iterations() * noiseArray.size());
+}
+
+void BM_populateNoiseArrayScalar(benchmark::State& state) {
+    benchmarkPopulateNoiseArray(state, &NoiseGeneratorImproved::populateNoiseArrayScalar);
+}
+
+#if NOISE_SIMD
+void BM_populateNoiseArraySse2(benchmark::State& state) {
+    benchmarkPopulateNoiseArray(state, &NoiseGeneratorImproved::populateNoiseArraySse2);
+}
+
+void BM_populateNoiseArrayAvx2(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("avx2 is not supported");
+        return;
+    }
+    benchmarkPopulateNoiseArray(state, &NoiseGeneratorImproved::populateNoiseArrayAvx2);
+}
+#endif
+
+using InterpolateChunk = decltype(&ChunkGeneratorHell::interpolateChunkScalar);
+
+// the interpolation part of BM_testGenChunk, on the noise of real chunks
+void benchmarkInterpolateChunk(benchmark::State& state, InterpolateChunk impl) {
+    ChunkGenExec exec;
+    std::vector<std::array<double, 5 * 17 * 5>> buffers;
+    for (int i = 0; i < 64; i++) {
+        buffers.push_back(generator.getHeights<5, 17, 5>(i * 4, 0, i * 8, exec));
+        Chunk expected{}, actual{};
+        ChunkGeneratorHell::interpolateChunkScalar(buffers.back().data(), 5, expected);
+        impl(buffers.back().data(), 5, actual);
+        if (memcmp(&expected, &actual, sizeof(Chunk)) != 0) {
+            state.SkipWithError("output does not match interpolateChunkScalar");
+            return;
+        }
+    }
+    int i = 0;
+    for (auto _ : state) {
+        Chunk chunk{};
+        impl(buffers[i++ % buffers.size()].data(), 5, chunk);
+        benchmark::DoNotOptimize(chunk);
+    }
+}
+
+void BM_interpolateChunkScalar(benchmark::State& state) {
+    benchmarkInterpolateChunk(state, &ChunkGeneratorHell::interpolateChunkScalar);
+}
+
+void BM_interpolateChunk(benchmark::State& state) {
+    benchmarkInterpolateChunk(state, [](const double* buffer, int zColumns, Chunk& primer) {
+        ChunkGeneratorHell::interpolateChunk(buffer, zColumns, primer);
+    });
+}
+
 //BENCHMARK(BM_testGetx2);
 //BENCHMARK(BM_testOldGetx2);
 //BENCHMARK(BM_testSetBlock);
@@ -164,7 +681,28 @@ void BM_generateNoiseOctaves(benchmark::State& state) {
 //BENCHMARK(BM_testMaxNoAttribute);
 //BENCHMARK(BM_testMax);
 //BENCHMARK(BM_testPathFind)->Range(1000, 128000)->RangeMultiplier(2)->Unit(benchmark::kSecond);
+BENCHMARK(BM_openSet)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_bidirectionalSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_symmetryPruning)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_incrementalReplanning)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_incrementalPathCost)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_anytimeSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_testGenChunk)/*->Iterations(10)*/->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_testGenChunkTiles)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_generateNeighbourTiles)->ArgsProduct({{0, 3, 6}, {0, 1}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_testGenChunkColumnCache)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_pregenerateRegion)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_generateNoiseOctaves)/*->Iterations(10)*/->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_getHeightsPerGenerator)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_parallelExecutorCompute)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_parallelExecutorWait)->ArgsProduct({{5, 50, 500}, {0, 1}})->UseRealTime()->MeasureProcessCPUTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_getHeights)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_interpolateChunkScalar)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_interpolateChunk)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_populateNoiseArrayScalar)->Unit(benchmark::kMicrosecond);
+#if NOISE_SIMD
+BENCHMARK(BM_populateNoiseArraySse2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_populateNoiseArrayAvx2)->Unit(benchmark::kMicrosecond);
+#endif
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -78,9 +78,8 @@ double totalLength(const Path& path) {
 
 void printSizes(const Path& path) {
     int x16 = 0, x8 = 0, x4 = 0, x2 = 0, x1 = 0;
-    for (const auto& nodePtr : path.nodes) {
-        const PathNode& node = *nodePtr;
-        const Size size = node.pos.size;
+    for (const PathNode& node : path.nodes) {
+        const Size size = node.pos.size();
 
         switch (size) {
             case Size::X16: x16++; break;
@@ -96,9 +95,9 @@ void printSizes(const Path& path) {
     std::cout << "X4 = " << x4 << '\n';
     std::cout << "X2 = " << x2 << '\n';
     std::cout << "X1 = " << x1 << '\n';
-    const PathNode& last = *path.nodes.back();
+    const PathNode& last = path.nodes.back();
     auto print = [](auto& node) {
-        switch (node.pos.size) {
+        switch (node.pos.size()) {
             case Size::X16: std::cout << "X16"; break;
             case Size::X8: std::cout << "X8"; break;
             case Size::X4: std::cout << "X4"; break;